@@ -0,0 +1,20 @@
+#version 410 core
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 cloudDepth;
+
+// Full-resolution premultiplied clouds, blended over the scene by the caller.
+uniform sampler2D uCloudHistory;
+// This frame's quarter-resolution march; its block depth stands in for the pixel's.
+uniform sampler2D uCloudLowRes;
+uniform sampler2D uCloudDepth;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    color = texelFetch(uCloudHistory, pixel, 0);
+
+    ivec2 block = min(pixel / 4, textureSize(uCloudLowRes, 0) - 1);
+    float blockAlpha = texelFetch(uCloudLowRes, block, 0).a;
+    float depth = blockAlpha > 1e-3 ? texelFetch(uCloudDepth, block, 0).r / blockAlpha : 1e7;
+    cloudDepth = vec4(depth * color.a, 0.0, 0.0, color.a);
+}
@@ -0,0 +1,48 @@
+#version 410 core
+out vec4 color;
+
+#include "include/common.glsl"
+
+// Quarter-resolution march of this frame: one pixel of every 4x4 block (uPixelOffset
+// within the block), premultiplied color + premultiplied cloud depth.
+uniform sampler2D uCloudLowRes;
+uniform sampler2D uCloudDepth;
+// Full-resolution result of the previous frame.
+uniform sampler2D uCloudHistory;
+
+uniform vec2 uPixelOffset;
+uniform bool uHistoryValid;
+
+// Every pixel is re-marched once per 16 frames; in between it is fetched from where the
+// previous frame's camera saw the same point, placed at this frame's cloud depth.
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 lowSize = textureSize(uCloudLowRes, 0);
+    ivec2 block = min(pixel / 4, lowSize - 1);
+
+    vec4 current = texelFetch(uCloudLowRes, block, 0);
+    if(pixel - block * 4 == ivec2(uPixelOffset))
+    {
+        color = current;
+        return;
+    }
+
+    vec2 res = vec2(max(screenWidth, 1.0), max(screenHeight, 1.0));
+    if(uHistoryValid)
+    {
+        // Empty blocks carry no depth; far away only the rotation matters.
+        float depth = current.a > 1e-3 ? texelFetch(uCloudDepth, block, 0).r / current.a : 1e7;
+        vec3 worldPos = cameraPosition + cameraRayDirectionAt(gl_FragCoord.xy) * depth;
+
+        vec2 prev;
+        if(previousPixel(worldPos, prev) && all(greaterThanEqual(prev, vec2(0.0))) && all(lessThan(prev, res)))
+        {
+            color = texture(uCloudHistory, prev / res);
+            return;
+        }
+    }
+
+    // Newly revealed or no history yet: the quarter-resolution march, filtered.
+    color = texture(uCloudLowRes, gl_FragCoord.xy / (vec2(lowSize) * 4.0));
+}
@@ -0,0 +1,78 @@
+#version 410 core
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 cloudDepth;
+
+#include "include/ocean.glsl"
+
+// Reduced-resolution clouds (premultiplied RGBA16F + premultiplied depth) and its scale
+// to the window.
+uniform sampler2D uCloudLowRes;
+uniform sampler2D uCloudDepth;
+uniform float uPixelScale;
+
+// How fast a tap's weight falls off with the relative difference of the guide distances.
+const float GUIDE_SHARPNESS = 8.0;
+
+float guideDistance(vec2 pixel)
+{
+    return oceanHitDistance(cameraPosition, cameraRayDirectionAt(pixel));
+}
+
+// Joint bilateral upsample: the four nearest low-resolution texels are blended
+// bilinearly, but each tap is down-weighted when the ocean distance at its center
+// differs from this pixel's, so clouds do not bleed across the horizon.
+void main()
+{
+    ivec2 lowSize = textureSize(uCloudLowRes, 0);
+    vec2 lowPos = gl_FragCoord.xy / uPixelScale - 0.5;
+    ivec2 base = ivec2(floor(lowPos));
+    vec2 f = lowPos - vec2(base);
+
+    float dHigh = guideDistance(gl_FragCoord.xy);
+
+    vec4 sum = vec4(0.0);
+    float depthSum = 0.0;
+    float weightSum = 0.0;
+    vec4 nearest = vec4(0.0);
+    float nearestDepth = 0.0;
+    float nearestDiff = 1e30;
+
+    for(int y = 0; y < 2; ++y)
+    {
+        for(int x = 0; x < 2; ++x)
+        {
+            ivec2 tap = clamp(base + ivec2(x, y), ivec2(0), lowSize - 1);
+            vec4 c = texelFetch(uCloudLowRes, tap, 0);
+            float d = texelFetch(uCloudDepth, tap, 0).r;
+
+            float dLow = guideDistance((vec2(tap) + 0.5) * uPixelScale);
+            float diff = abs(dLow - dHigh) / min(dLow, dHigh);
+
+            float bilinear = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+            float w = bilinear * exp(-diff * GUIDE_SHARPNESS);
+
+            sum += c * w;
+            depthSum += d * w;
+            weightSum += w;
+
+            if(diff < nearestDiff)
+            {
+                nearestDiff = diff;
+                nearest = c;
+                nearestDepth = d;
+            }
+        }
+    }
+
+    // Every tap is across an edge: take the one whose guide matches best.
+    if(weightSum > 1e-4)
+    {
+        color = sum / weightSum;
+        cloudDepth = vec4(depthSum / weightSum, 0.0, 0.0, color.a);
+    }
+    else
+    {
+        color = nearest;
+        cloudDepth = vec4(nearestDepth, 0.0, 0.0, color.a);
+    }
+}
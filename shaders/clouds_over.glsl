@@ -1,92 +1,21 @@
 #version 330 core
-out vec4 color;
+layout(location = 0) out vec4 color;
+// Transmittance-weighted distance of the clouds along the ray, premultiplied by coverage
+// like the color, so the overlay blend mixes it with the ocean distance underneath.
+// Only stored when the target has a second attachment (reprojection).
+layout(location = 1) out vec4 cloudDepth;
 
-uniform float Time;
-uniform float screenWidth;
-uniform float screenHeight;
+#ifndef CLOUD_PRIMARY_STEPS
+#define CLOUD_PRIMARY_STEPS 84
+#endif
 
-uniform vec3 cameraPosition;
-uniform vec3 cameraFront;
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
+#include "include/cloud_lighting.glsl"
 
-uniform vec3 EarthCenter;
-uniform vec2 HaltonSequence;
-
-uniform float CloudBottom;
-uniform float CloudTop;
-
-uniform sampler3D lowFrequencyTexture;
-uniform sampler3D highFrequencyTexture;
-uniform sampler2D WeatherTexture;
-uniform sampler2D CurlNoiseTexture;
-
-const float PI = 3.14159265;
-const float EARTH_RADIUS = 6378000.0;
-
-float saturate(float x){ return clamp(x,0.0,1.0); }
-
-bool sphereIntersect(vec3 ro, vec3 rd, vec3 c, float r, out float t0, out float t1)
-{
-    vec3 oc = ro - c;
-    float b = dot(oc, rd);
-    float c2 = dot(oc, oc) - r*r;
-    float h = b*b - c2;
-    if(h < 0.0) return false;
-    h = sqrt(h);
-    t0 = -b - h;
-    t1 = -b + h;
-    return true;
-}
-
-float heightFraction(vec3 worldPos)
-{
-    float h = length(worldPos - EarthCenter) - EARTH_RADIUS;
-    return saturate((h - CloudBottom) / max(CloudTop - CloudBottom, 1.0));
-}
-
-float phaseHG(float g, float cosT)
-{
-    float g2 = g*g;
-    float denom = pow(1.0 + g2 - 2.0*g*cosT, 1.5);
-    return (1.0 - g2) / max(4.0 * PI * denom, 1e-6);
-}
-
-float sampleCloudDensity(vec3 worldPos)
-{
-    float hf = heightFraction(worldPos);
-    if(hf <= 0.0 || hf >= 1.0) return 0.0;
-
-    vec3 rel = worldPos - EarthCenter;
-    vec3 p = rel / 8000.0;
-
-    vec2 curl = texture(CurlNoiseTexture, fract(p.xz * 0.05 + vec2(Time*0.01, -Time*0.013))).rg * 2.0 - 1.0;
-    p.xz += curl * 0.35;
-
-    vec4 lf = texture(lowFrequencyTexture, fract(p * 0.25 + vec3(Time*0.01, 0.0, 0.0)));
-
-    float base = lf.r;
-    float worleyFBM = lf.g * 0.625 + lf.b * 0.25 + lf.a * 0.125;
-    worleyFBM = saturate(worleyFBM);
-
-    float shape = smoothstep(0.52 - 0.30*worleyFBM, 0.84, base);
-
-    vec2 wuv = fract(rel.xz / 200000.0 + 0.5);
-    float coverage = texture(WeatherTexture, wuv).r;
-    coverage = mix(0.20, 0.70, coverage);
-
-    float heightMask = smoothstep(0.0, 0.22, hf) * (1.0 - smoothstep(0.70, 1.0, hf));
-    shape *= heightMask;
-
-    shape = saturate((shape - (1.0 - coverage)) / max(coverage, 1e-4));
-
-    float hfNoise = texture(highFrequencyTexture, fract(p * 0.9 + vec3(0.0, Time*0.02, 0.0))).r;
-    shape -= (1.0 - hfNoise) * 0.26;
-
-    shape = max(0.0, shape - 0.018);
-
-    return saturate(shape);
-}
+// Target pixel -> full-resolution pixel: floor(gl_FragCoord) * uPixelScale + uPixelOffset.
+// Scale 1 when drawn straight over the ocean, 2 or 4 in the reduced cloud target; the
+// offset picks the block's center, or this frame's pixel of each 4x4 block when interleaved.
+uniform float uPixelScale;
+uniform vec2 uPixelOffset;
 
 vec3 tonemap(vec3 x)
 {
@@ -95,12 +24,8 @@ vec3 tonemap(vec3 x)
 
 void main()
 {
-    vec2 res = vec2(max(screenWidth, 1.0), max(screenHeight, 1.0));
-    vec2 uv = (gl_FragCoord.xy / res) * 2.0 - 1.0;
-    uv.x *= res.x / res.y;
-
     vec3 ro = cameraPosition;
-    vec3 rd = normalize(cameraFront * 1.6 + cameraRight * uv.x + cameraUp * uv.y);
+    vec3 rd = cameraRayDirectionAt(floor(gl_FragCoord.xy) * uPixelScale + uPixelOffset);
 
     float rOuter = EARTH_RADIUS + CloudTop;
 
@@ -108,13 +33,14 @@ void main()
     if(!sphereIntersect(ro, rd, EarthCenter, rOuter, tAtm0, tAtm1))
     {
         color = vec4(0.0);
+        cloudDepth = vec4(0.0);
         return;
     }
 
     float t0 = max(tAtm0, 0.0);
     float t1 = tAtm1;
 
-    int steps = 84;
+    int steps = CLOUD_PRIMARY_STEPS;
     float segLen = max(t1 - t0, 0.0);
     float stepSize = segLen / float(steps);
 
@@ -126,6 +52,8 @@ void main()
 
     float trans = 1.0;
     vec3 accum = vec3(0.0);
+    float depthSum = 0.0;
+    float depthWeight = 0.0;
 
     const float EXT = 0.0012;
     const float SCA = 0.0010;
@@ -135,18 +63,10 @@ void main()
         float t = t0 + (float(i) + 0.5) * stepSize;
         vec3 p = ro + rd * t;
 
-        float dens = sampleCloudDensity(p);
+        float dens = sampleCloudDensity(p, t, stepSize);
         if(dens <= 0.0005) continue;
 
-        float shadow = 0.0;
-        vec3 lp = p;
-        float lStep = 350.0;
-        for(int k = 0; k < 8; ++k)
-        {
-            lp += lightDir * lStep;
-            shadow += sampleCloudDensity(lp);
-        }
-        float lightTrans = exp(-shadow * 1.35);
+        float lightTrans = cloudLightTransmittance(p, lightDir, t);
 
         float cosT = dot(rd, lightDir);
         float ph = phaseHG(0.60, cosT);
@@ -157,7 +77,10 @@ void main()
         vec3 src = (sunCol * lightTrans * ph + ambient) * dens;
 
         accum += trans * src * stepSize * SCA;
-        trans *= exp(-dens * stepSize * EXT);
+        float absorbed = trans * (1.0 - exp(-dens * stepSize * EXT));
+        depthSum += t * absorbed;
+        depthWeight += absorbed;
+        trans -= absorbed;
 
         if(trans < 0.01) break;
     }
@@ -170,4 +93,6 @@ void main()
     rgb *= alpha;
 
     color = vec4(rgb, alpha);
+    float depth = depthWeight > 0.0 ? depthSum / depthWeight : 0.5 * (t0 + t1);
+    cloudDepth = vec4(depth * alpha, 0.0, 0.0, alpha);
 }
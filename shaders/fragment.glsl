@@ -1,26 +1,15 @@
 #version 330 core
 out vec4 color;
 
-uniform float screenWidth;
-uniform float screenHeight;
-
-uniform vec3 cameraFront;
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
-
-float saturate(float x){ return clamp(x,0.0,1.0); }
+#include "include/atmosphere.glsl"
 
 vec3 skyColor(vec3 rd)
 {
-    float t = saturate(rd.y * 0.5 + 0.5);
-    return mix(vec3(0.03,0.05,0.08), vec3(0.35,0.52,0.85), t);
+    return skyGradient(rd, 0.5);
 }
 
 void main()
 {
-    vec2 res = vec2(max(screenWidth,1.0), max(screenHeight,1.0));
-    vec2 ndc = (gl_FragCoord.xy / res) * 2.0 - 1.0;
-    ndc.x *= res.x / res.y;
-    vec3 rd = normalize(cameraFront * 1.6 + cameraRight * ndc.x + cameraUp * ndc.y);
+    vec3 rd = cameraRayDirection();
     color = vec4(skyColor(rd), 1.0);
 }
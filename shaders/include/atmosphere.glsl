@@ -0,0 +1,36 @@
+#include "common.glsl"
+
+const vec3 SUN_DIRECTION = normalize(vec3(0.4, 0.9, 0.2));
+
+// Zenith/horizon gradient. horizonBias shifts where the gradient crosses the horizon.
+vec3 skyGradient(vec3 rd, float horizonBias)
+{
+    float t = saturate(rd.y * 0.5 + horizonBias);
+    return mix(vec3(0.03,0.05,0.08), vec3(0.35,0.52,0.85), t);
+}
+
+vec3 skyWithSun(vec3 rd, float horizonBias, float sunPower, vec3 sunColor)
+{
+    float sun = pow(max(dot(rd, SUN_DIRECTION), 0.0), sunPower);
+    return skyGradient(rd, horizonBias) + sun * sunColor;
+}
+
+bool sphereIntersect(vec3 ro, vec3 rd, vec3 c, float r, out float t0, out float t1)
+{
+    vec3 oc = ro - c;
+    float b = dot(oc, rd);
+    float c2 = dot(oc, oc) - r*r;
+    float h = b*b - c2;
+    if(h < 0.0) return false;
+    h = sqrt(h);
+    t0 = -b - h;
+    t1 = -b + h;
+    return true;
+}
+
+// 0 at the cloud layer bottom, 1 at its top.
+float heightFraction(vec3 worldPos)
+{
+    float h = length(worldPos - EarthCenter) - EARTH_RADIUS;
+    return saturate((h - CloudBottom) / max(CloudTop - CloudBottom, 1.0));
+}
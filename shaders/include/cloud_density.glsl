@@ -0,0 +1,96 @@
+#include "atmosphere.glsl"
+
+// Quality switches, overridden per tier through ShaderDefines.
+#ifndef CLOUD_HF_EROSION
+#define CLOUD_HF_EROSION 1
+#endif
+#ifndef CLOUD_CURL
+#define CLOUD_CURL 1
+#endif
+// Erosion fades out towards this ray distance (meters) and is not fetched beyond it.
+#ifndef CLOUD_HF_EROSION_DISTANCE
+#define CLOUD_HF_EROSION_DISTANCE 30000.0
+#endif
+
+// World size of one texture tile: noise space is 8 km per unit, sampled at p*0.25 / p*0.9.
+const float LOW_FREQUENCY_TILE = 8000.0 / 0.25;
+const float HIGH_FREQUENCY_TILE = 8000.0 / 0.9;
+
+uniform sampler3D lowFrequencyTexture;
+uniform sampler3D highFrequencyTexture;
+uniform sampler2D WeatherTexture;
+uniform sampler2D CurlNoiseTexture;
+
+// Noise-space position (8 km per unit) with the animated curl distortion applied.
+vec3 cloudNoisePosition(vec3 worldPos)
+{
+    vec3 p = (worldPos - EarthCenter) / 8000.0;
+
+#if CLOUD_CURL
+    vec2 curl = texture(CurlNoiseTexture, fract(p.xz * 0.05 + vec2(Time*0.01, -Time*0.013))).rg * 2.0 - 1.0;
+    p.xz += curl * 0.35;
+#endif
+    return p;
+}
+
+// Length a sample stands for: the march step, or the pixel width if that is larger.
+float cloudSampleFootprint(float rayDistance, float stepSize)
+{
+    return max(stepSize, rayDistance * cameraPixelAngle());
+}
+
+// Mip level whose texels match the footprint, so distant samples read small, cache
+// friendly levels instead of aliasing level 0.
+float cloudNoiseLod(sampler3D tex, float tileSize, float footprint)
+{
+    float texel = tileSize / float(textureSize(tex, 0).x);
+    return max(0.0, log2(max(footprint, 1.0) / texel));
+}
+
+// rayDistance = ray distance from the camera, stepSize = march step (both meters).
+float sampleCloudDensity(vec3 worldPos, float rayDistance, float stepSize)
+{
+    float hf = heightFraction(worldPos);
+    if(hf <= 0.0 || hf >= 1.0) return 0.0;
+
+    vec3 rel = worldPos - EarthCenter;
+    vec3 p = cloudNoisePosition(worldPos);
+
+    float footprint = cloudSampleFootprint(rayDistance, stepSize);
+    vec4 lf = textureLod(lowFrequencyTexture, fract(p * 0.25 + vec3(Time*0.01, 0.0, 0.0)),
+                         cloudNoiseLod(lowFrequencyTexture, LOW_FREQUENCY_TILE, footprint));
+    float base = lf.r;
+    float worleyFBM = lf.g * 0.625 + lf.b * 0.25 + lf.a * 0.125;
+    worleyFBM = saturate(worleyFBM);
+
+    float shape = smoothstep(0.52 - 0.30*worleyFBM, 0.84, base);
+
+    vec2 wuv = fract(rel.xz / 200000.0 + 0.5);
+    float coverage = texture(WeatherTexture, wuv).r;
+    coverage = mix(0.20, 0.70, coverage);
+
+    float heightMask = smoothstep(0.0, 0.22, hf) * (1.0 - smoothstep(0.70, 1.0, hf));
+    shape *= heightMask;
+
+    shape = saturate((shape - (1.0 - coverage)) / max(coverage, 1e-4));
+    if(shape <= 0.0) return 0.0;
+
+#if CLOUD_HF_EROSION
+    float erosion = 1.0 - smoothstep(CLOUD_HF_EROSION_DISTANCE * 0.7, CLOUD_HF_EROSION_DISTANCE, rayDistance);
+    if(erosion > 0.0)
+    {
+        float hfNoise = textureLod(highFrequencyTexture, fract(p * 0.9 + vec3(0.0, Time*0.02, 0.0)),
+                                   cloudNoiseLod(highFrequencyTexture, HIGH_FREQUENCY_TILE, footprint)).r;
+        shape -= (1.0 - hfNoise) * 0.26 * erosion;
+    }
+#endif
+
+    shape = max(0.0, shape - 0.018);
+    return saturate(shape);
+}
+
+// Full-detail sample (level 0, erosion always on).
+float sampleCloudDensity(vec3 worldPos)
+{
+    return sampleCloudDensity(worldPos, 0.0, 0.0);
+}
@@ -0,0 +1,35 @@
+#include "cloud_density.glsl"
+
+#ifndef CLOUD_LIGHT_SAMPLES
+#define CLOUD_LIGHT_SAMPLES 8
+#endif
+
+float phaseHG(float g, float cosT)
+{
+    float g2 = g*g;
+    float denom = pow(1.0 + g2 - 2.0*g*cosT, 1.5);
+    return (1.0 - g2) / max(4.0 * PI * denom, 1e-6);
+}
+
+// Beer-Lambert transmittance towards the sun over 2.8 km. The step length and
+// optical-depth scale follow CLOUD_LIGHT_SAMPLES (8 taps = 350 m apart). rayDistance is
+// the primary sample's ray distance and picks the noise LOD.
+float cloudLightTransmittance(vec3 p, vec3 lightDir, float rayDistance)
+{
+    const float sampleScale = 8.0 / float(CLOUD_LIGHT_SAMPLES);
+    const float lightStep = 350.0 * sampleScale;
+
+    float shadow = 0.0;
+    vec3 lp = p;
+    for(int k=0;k<CLOUD_LIGHT_SAMPLES;k++)
+    {
+        lp += lightDir * lightStep;
+        shadow += sampleCloudDensity(lp, rayDistance, lightStep);
+    }
+    return exp(-shadow * 1.35 * sampleScale);
+}
+
+float cloudLightTransmittance(vec3 p, vec3 lightDir)
+{
+    return cloudLightTransmittance(p, lightDir, 0.0);
+}
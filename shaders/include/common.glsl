@@ -0,0 +1,45 @@
+#include "frame_data.glsl"
+
+const float PI = 3.14159265;
+const float EARTH_RADIUS = 6378000.0;
+
+float saturate(float x){ return clamp(x,0.0,1.0); }
+
+const float CAMERA_FOCAL_LENGTH = 1.6;
+
+// View ray through a point given in full-resolution window pixels (fixed focal length,
+// aspect corrected).
+vec3 cameraRayDirectionAt(vec2 pixel)
+{
+    vec2 res = vec2(max(screenWidth,1.0), max(screenHeight,1.0));
+    vec2 ndc = (pixel / res) * 2.0 - 1.0;
+    ndc.x *= res.x / res.y;
+    return normalize(cameraFront * CAMERA_FOCAL_LENGTH + cameraRight * ndc.x + cameraUp * ndc.y);
+}
+
+// View ray through the current fragment.
+vec3 cameraRayDirection()
+{
+    return cameraRayDirectionAt(gl_FragCoord.xy);
+}
+
+// Full-resolution window pixel at which the previous frame's camera saw worldPos.
+// False when the point was behind that camera.
+bool previousPixel(vec3 worldPos, out vec2 pixel)
+{
+    vec3 d = worldPos - prevCameraPosition;
+    float z = dot(d, prevCameraFront);
+    if(z <= 0.0) return false;
+
+    vec2 res = vec2(max(screenWidth,1.0), max(screenHeight,1.0));
+    vec2 ndc = vec2(dot(d, prevCameraRight), dot(d, prevCameraUp)) * (CAMERA_FOCAL_LENGTH / z);
+    ndc.x *= res.y / res.x;
+    pixel = (ndc * 0.5 + 0.5) * res;
+    return true;
+}
+
+// Angle (radians) covered by one pixel near the view center.
+float cameraPixelAngle()
+{
+    return 2.0 / (CAMERA_FOCAL_LENGTH * max(screenHeight, 1.0));
+}
@@ -0,0 +1,15 @@
+// Per-frame parameters, filled once per frame by FrameUniformBuffer (binding 0).
+layout(std140) uniform FrameData
+{
+    vec3 cameraPosition; float Time;
+    vec3 cameraFront;    float screenWidth;
+    vec3 cameraUp;       float screenHeight;
+    vec3 cameraRight;    float CloudBottom;
+    vec3 EarthCenter;    float CloudTop;
+    vec2 HaltonSequence; vec2 resolution;
+    // Camera of the previous frame (same as the current one on the first frame).
+    vec3 prevCameraPosition; float _pad0;
+    vec3 prevCameraFront;    float _pad1;
+    vec3 prevCameraUp;       float _pad2;
+    vec3 prevCameraRight;    float _pad3;
+};
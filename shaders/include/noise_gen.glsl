@@ -0,0 +1,160 @@
+// GPU twin of src/NoiseGenerator.cpp. Every constant and operation mirrors the CPU code
+// (same hashes, same evaluation order) so both produce the same textures; `precise`
+// keeps the compiler from fusing multiply-adds the CPU path does not fuse.
+
+const int WORLEY_OCTAVES = 5;
+const int PERLIN_OCTAVES = 5;
+const int CURL_OCTAVES = 3;
+const float CURL_SCALE = 1.0 / 32.0;
+
+uint mixSeed(uint seed, uint salt)
+{
+    uint h = seed + salt * 0x9e3779b9u;
+    h ^= h >> 16; h *= 0x7feb352du;
+    h ^= h >> 15; h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+uint hashCell(ivec3 c, uint seed)
+{
+    uint h = seed ^ (uint(c.x) * 0x8da6b343u) ^ (uint(c.y) * 0xd8163841u) ^ (uint(c.z) * 0xcb1ab31fu);
+    h ^= h >> 16; h *= 0x7feb352du;
+    h ^= h >> 15; h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+int wrapCell(int c, int period)
+{
+    return c < 0 ? c + period : (c >= period ? c - period : c);
+}
+
+ivec3 wrapCell(ivec3 c, int period)
+{
+    return ivec3(wrapCell(c.x, period), wrapCell(c.y, period), wrapCell(c.z, period));
+}
+
+float unit10(uint h, int shift)
+{
+    return float((h >> uint(shift)) & 1023u) * (1.0 / 1024.0);
+}
+
+float gradDot(uint h, float x, float y, float z)
+{
+    uint hh = h & 15u;
+    float u = hh < 8u ? x : y;
+    float v = hh < 4u ? y : (hh == 12u || hh == 14u ? x : z);
+    return ((hh & 1u) != 0u ? -u : u) + ((hh & 2u) != 0u ? -v : v);
+}
+
+// Distance to the nearest feature point, p in cell units on a `period`-cell torus.
+float worley(vec3 p, int period, uint seed)
+{
+    ivec3 c = ivec3(floor(p));
+    precise vec3 f = p - vec3(c);
+
+    precise float best = 8.0;
+    for(int dz = -1; dz <= 1; ++dz)
+    for(int dy = -1; dy <= 1; ++dy)
+    for(int dx = -1; dx <= 1; ++dx)
+    {
+        uint h = hashCell(wrapCell(c + ivec3(dx, dy, dz), period), seed);
+        precise float ox = float(dx) + unit10(h, 0) - f.x;
+        precise float oy = float(dy) + unit10(h, 10) - f.y;
+        precise float oz = float(dz) + unit10(h, 20) - f.z;
+        best = min(best, ox * ox + oy * oy + oz * oz);
+    }
+    return sqrt(best);
+}
+
+float fade(float t)
+{
+    precise float r = t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+    return r;
+}
+
+float lerpPrecise(float a, float b, float t)
+{
+    precise float r = a + (b - a) * t;
+    return r;
+}
+
+// Gradient noise in roughly [-1, 1], tiling every `period` cells.
+float perlin(vec3 p, int period, uint seed)
+{
+    ivec3 i = ivec3(floor(p));
+    precise vec3 f = p - vec3(i);
+    ivec3 i0 = wrapCell(i, period);
+    ivec3 i1 = wrapCell(i + ivec3(1), period);
+    precise vec3 g = f - vec3(1.0);
+
+    float n000 = gradDot(hashCell(ivec3(i0.x, i0.y, i0.z), seed), f.x, f.y, f.z);
+    float n100 = gradDot(hashCell(ivec3(i1.x, i0.y, i0.z), seed), g.x, f.y, f.z);
+    float n010 = gradDot(hashCell(ivec3(i0.x, i1.y, i0.z), seed), f.x, g.y, f.z);
+    float n110 = gradDot(hashCell(ivec3(i1.x, i1.y, i0.z), seed), g.x, g.y, f.z);
+    float n001 = gradDot(hashCell(ivec3(i0.x, i0.y, i1.z), seed), f.x, f.y, g.z);
+    float n101 = gradDot(hashCell(ivec3(i1.x, i0.y, i1.z), seed), g.x, f.y, g.z);
+    float n011 = gradDot(hashCell(ivec3(i0.x, i1.y, i1.z), seed), f.x, g.y, g.z);
+    float n111 = gradDot(hashCell(ivec3(i1.x, i1.y, i1.z), seed), g.x, g.y, g.z);
+
+    float ux = fade(f.x), uy = fade(f.y), uz = fade(f.z);
+    float nx00 = lerpPrecise(n000, n100, ux), nx10 = lerpPrecise(n010, n110, ux);
+    float nx01 = lerpPrecise(n001, n101, ux), nx11 = lerpPrecise(n011, n111, ux);
+    return lerpPrecise(lerpPrecise(nx00, nx10, uy), lerpPrecise(nx01, nx11, uy), uz);
+}
+
+// RGBA of the low- (R = Perlin-Worley, GBA = Worley FBM) or high-frequency volume
+// (RGB = Worley FBM) at voxel center uvw, in tile units.
+vec4 noiseVolumeVoxel(bool lowFrequency, vec3 uvw, uint seed)
+{
+    int baseFrequency = lowFrequency ? 4 : 2;
+
+    float worleyOctave[WORLEY_OCTAVES];
+    for(int o = 0; o < WORLEY_OCTAVES; ++o)
+    {
+        int f = baseFrequency << o;
+        precise vec3 p = uvw * float(f);
+        worleyOctave[o] = 1.0 - clamp(worley(p, f, mixSeed(seed, 0x100u + uint(o))), 0.0, 1.0);
+    }
+    float fbm[3];
+    for(int k = 0; k < 3; ++k)
+    {
+        precise float octaves = worleyOctave[k] * 0.625 + worleyOctave[k + 1] * 0.25 + worleyOctave[k + 2] * 0.125;
+        fbm[k] = octaves;
+    }
+
+    if(!lowFrequency)
+        return vec4(fbm[0], fbm[1], fbm[2], 1.0);
+
+    precise float noise = 0.0;
+    float amplitude = 1.0, total = 0.0;
+    for(int o = 0; o < PERLIN_OCTAVES; ++o)
+    {
+        int f = baseFrequency << o;
+        precise vec3 p = uvw * float(f);
+        noise = noise + perlin(p, f, mixSeed(seed, 0x200u + uint(o))) * amplitude;
+        total += amplitude;
+        amplitude *= 0.5;
+    }
+    noise = clamp(noise * (0.5 / total) + 0.5, 0.0, 1.0);
+    precise float perlinWorley = fbm[0] + noise * (1.0 - fbm[0]);
+    return vec4(perlinWorley, fbm[0], fbm[1], fbm[2]);
+}
+
+float curlPotential(int size, uint seed, ivec2 texel)
+{
+    float scale = 1.0 / float(size);
+    precise vec2 uv = (vec2(texel) + 0.5) * scale;
+
+    precise float potential = 0.0;
+    float amplitude = 1.0;
+    for(int o = 0; o < CURL_OCTAVES; ++o)
+    {
+        int f = 4 << o;
+        precise vec3 p = vec3(uv * float(f), 0.5);
+        potential = potential + perlin(p, f, mixSeed(seed, 0x300u + uint(o))) * amplitude;
+        amplitude *= 0.5;
+    }
+    return potential;
+}
@@ -0,0 +1,13 @@
+#include "common.glsl"
+
+const float OCEAN_HEIGHT = 0.0;
+// Distance reported for rays that never reach the water (sky).
+const float OCEAN_NO_HIT = 1e7;
+
+// Distance along rd to the ocean plane, or OCEAN_NO_HIT.
+float oceanHitDistance(vec3 ro, vec3 rd)
+{
+    if(rd.y >= -1e-5) return OCEAN_NO_HIT;
+    float t = (OCEAN_HEIGHT - ro.y) / rd.y;
+    return t > 0.0 ? t : OCEAN_NO_HIT;
+}
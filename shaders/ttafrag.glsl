@@ -1,17 +1,72 @@
-#version 330 core
+#version 410 core
 out vec4 color;
-in vec2 vUV;
+layout (location = 0) in vec2 vUV;
+
+#include "include/common.glsl"
 
 uniform sampler2D uCurrent;
+// Resolved previous frame; alpha holds log2(1 + its view distance).
 uniform sampler2D uHistory;
+// View distance of this frame's pixels (ocean / clouds, coverage weighted).
+uniform sampler2D uSceneDepth;
 
+uniform mat4 uViewProj;
+uniform mat4 uPrevViewProj;
 uniform vec2 uResolution;
 uniform float uAlpha;
 
+// Largest log2 distance ratio still treated as the same surface.
+const float DISOCCLUSION_LOG2 = 0.25;
+
+vec2 projectUV(mat4 viewProj, vec3 worldPos, out bool inFront)
+{
+    vec4 clip = viewProj * vec4(worldPos, 1.0);
+    inFront = clip.w > 0.0;
+    return clip.xy / max(clip.w, 1e-6) * 0.5 + 0.5;
+}
+
 void main()
 {
-    vec3 cur = texture(uCurrent, vUV).rgb;
-    vec3 hist = texture(uHistory, vUV).rgb;
-    vec3 outc = mix(cur, hist, clamp(uAlpha, 0.0, 0.99));
-    color = vec4(outc, 1.0);
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = ivec2(uResolution);
+    vec3 cur = texelFetch(uCurrent, pixel, 0).rgb;
+
+    // Color box of the 3x3 neighborhood: history outside it belongs to something else.
+    vec3 boxMin = cur;
+    vec3 boxMax = cur;
+    for(int y = -1; y <= 1; ++y)
+    {
+        for(int x = -1; x <= 1; ++x)
+        {
+            vec3 c = texelFetch(uCurrent, clamp(pixel + ivec2(x, y), ivec2(0), size - 1), 0).rgb;
+            boxMin = min(boxMin, c);
+            boxMax = max(boxMax, c);
+        }
+    }
+
+    float depth = texelFetch(uSceneDepth, pixel, 0).r;
+    vec3 worldPos = cameraPosition + cameraRayDirection() * depth;
+    float depthLog = log2(1.0 + depth);
+
+    bool curFront, prevFront;
+    vec2 motion = projectUV(uViewProj, worldPos, curFront) - projectUV(uPrevViewProj, worldPos, prevFront);
+    vec2 historyUV = vUV - motion;
+
+    float alpha = uAlpha;
+    if(!prevFront || any(lessThan(historyUV, vec2(0.0))) || any(greaterThan(historyUV, vec2(1.0))))
+        alpha = 0.0;
+
+    vec3 result = cur;
+    if(alpha > 0.0)
+    {
+        vec4 hist = texture(uHistory, historyUV);
+
+        // The previous frame saw something at another distance there: newly revealed.
+        float expectedLog = log2(1.0 + length(worldPos - prevCameraPosition));
+        if(abs(hist.a - expectedLog) > DISOCCLUSION_LOG2) alpha = 0.0;
+
+        result = mix(cur, clamp(hist.rgb, boxMin, boxMax), clamp(alpha, 0.0, 0.99));
+    }
+
+    color = vec4(result, depthLog);
 }
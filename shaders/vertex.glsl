@@ -1,6 +1,13 @@
-#version 330 core
+#version 410 core
 layout (location = 0) in vec3 aPos;
-out vec2 vUV;
+layout (location = 0) out vec2 vUV;
+
+// Separable program: the built-in block has to be redeclared.
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
 void main()
 {
     vUV = aPos.xy * 0.5 + 0.5;
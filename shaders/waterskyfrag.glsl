@@ -1,16 +1,10 @@
 #version 330 core
-out vec4 color;
+layout(location = 0) out vec4 color;
+// Distance along the view ray (OCEAN_NO_HIT for sky), kept for TAA reprojection.
+layout(location = 1) out vec4 sceneDepth;
 
-uniform float Time;
-uniform float screenWidth;
-uniform float screenHeight;
-
-uniform vec3 cameraPosition;
-uniform vec3 cameraFront;
-uniform vec3 cameraUp;
-uniform vec3 cameraRight;
-
-float saturate(float x){ return clamp(x,0.0,1.0); }
+#include "include/atmosphere.glsl"
+#include "include/ocean.glsl"
 
 float hash(vec2 p){
     p = fract(p*vec2(123.34,456.21));
@@ -48,30 +42,17 @@ float waves(vec2 xz, float t){
 }
 
 vec3 skyColor(vec3 rd){
-    vec3 lightDir = normalize(vec3(0.4, 0.9, 0.2));
-    float sun = pow(max(dot(rd, lightDir), 0.0), 128.0);
-    vec3 base = mix(vec3(0.03,0.05,0.08), vec3(0.35,0.52,0.85), saturate(rd.y*0.5+0.6));
-    base += sun * vec3(1.0, 0.85, 0.55) * 0.55;
-    return base;
+    return skyWithSun(rd, 0.6, 128.0, vec3(1.0, 0.85, 0.55) * 0.55);
 }
 
 void main(){
-    vec2 res = vec2(max(screenWidth,1.0), max(screenHeight,1.0));
-    vec2 ndc = (gl_FragCoord.xy / res) * 2.0 - 1.0;
-    ndc.x *= res.x / res.y;
-
-    vec3 rd = normalize(cameraFront * 1.6 + cameraRight * ndc.x + cameraUp * ndc.y);
+    vec3 rd = cameraRayDirection();
     vec3 ro = cameraPosition;
 
-    float waterY = 0.0;
-
-    if(rd.y >= -1e-5){
-        color = vec4(skyColor(rd), 1.0);
-        return;
-    }
-
-    float tHit = (waterY - ro.y) / rd.y;
-    if(tHit <= 0.0){
+    // Same distance cloud_upsample.glsl uses as its edge guide.
+    float tHit = oceanHitDistance(ro, rd);
+    sceneDepth = vec4(tHit, 0.0, 0.0, 1.0);
+    if(tHit >= OCEAN_NO_HIT){
         color = vec4(skyColor(rd), 1.0);
         return;
     }
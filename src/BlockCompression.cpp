@@ -0,0 +1,232 @@
+#include "BlockCompression.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+    // Palette of a block; r0 > r1 selects 8 interpolated values, otherwise 6 plus 0 and 255.
+    void BC4Palette(int r0, int r1, int palette[8]) {
+        palette[0] = r0;
+        palette[1] = r1;
+        if (r0 > r1) {
+            for (int i = 1; i < 7; ++i) palette[i + 1] = ((7 - i) * r0 + i * r1 + 3) / 7;
+        }
+        else {
+            for (int i = 1; i < 5; ++i) palette[i + 1] = ((5 - i) * r0 + i * r1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // Picks the nearest palette entry per texel; returns the squared error.
+    int BC4Indices(const unsigned char texels[16], const int palette[8], int indices[16]) {
+        int error = 0;
+        for (int t = 0; t < 16; ++t) {
+            int best = 0, bestError = 1 << 30;
+            for (int i = 0; i < 8; ++i) {
+                const int d = (int)texels[t] - palette[i];
+                if (d * d < bestError) {
+                    bestError = d * d;
+                    best = i;
+                }
+            }
+            indices[t] = best;
+            error += bestError;
+        }
+        return error;
+    }
+
+    int TryEndpoints(const unsigned char texels[16], int r0, int r1, int indices[16]) {
+        int palette[8];
+        BC4Palette(r0, r1, palette);
+        return BC4Indices(texels, palette, indices);
+    }
+
+    // Least-squares endpoints for fixed 8-value indices: value = w * r0 + (1 - w) * r1.
+    bool RefineEndpoints(const unsigned char texels[16], const int indices[16], int& r0, int& r1) {
+        double aa = 0, ab = 0, bb = 0, ax = 0, bx = 0;
+        for (int t = 0; t < 16; ++t) {
+            const int i = indices[t];
+            const double w = i == 0 ? 1.0 : (i == 1 ? 0.0 : (7.0 - (i - 1)) / 7.0);
+            aa += w * w;
+            ab += w * (1.0 - w);
+            bb += (1.0 - w) * (1.0 - w);
+            ax += w * texels[t];
+            bx += (1.0 - w) * texels[t];
+        }
+        const double det = aa * bb - ab * ab;
+        if (det < 1e-9) return false;
+        r0 = std::clamp((int)((ax * bb - bx * ab) / det + 0.5), 0, 255);
+        r1 = std::clamp((int)((bx * aa - ax * ab) / det + 0.5), 0, 255);
+        return r0 > r1;
+    }
+
+    void PackBC4(int r0, int r1, const int indices[16], unsigned char out[8]) {
+        out[0] = (unsigned char)r0;
+        out[1] = (unsigned char)r1;
+        uint64_t bits = 0;
+        for (int t = 0; t < 16; ++t) bits |= (uint64_t)indices[t] << (3 * t);
+        for (int b = 0; b < 6; ++b) out[2 + b] = (unsigned char)(bits >> (8 * b));
+    }
+
+    size_t BlockBytes(VolumeFormat format) { return format == VolumeFormat::BC4 ? 8 : 16; }
+}
+
+void EncodeBC4Block(const unsigned char texels[16], unsigned char out[8]) {
+    int lo = 255, hi = 0, innerLo = 255, innerHi = 0;
+    for (int t = 0; t < 16; ++t) {
+        lo = std::min(lo, (int)texels[t]);
+        hi = std::max(hi, (int)texels[t]);
+        if (texels[t] != 0 && texels[t] != 255) {
+            innerLo = std::min(innerLo, (int)texels[t]);
+            innerHi = std::max(innerHi, (int)texels[t]);
+        }
+    }
+
+    int indices[16], bestIndices[16];
+    int bestR0 = lo, bestR1 = lo;
+    int bestError = TryEndpoints(texels, lo, lo, bestIndices);
+    if (bestError == 0) {
+        PackBC4(bestR0, bestR1, bestIndices, out);
+        return;
+    }
+
+    auto consider = [&](int r0, int r1) {
+        const int error = TryEndpoints(texels, r0, r1, indices);
+        if (error < bestError) {
+            bestError = error;
+            bestR0 = r0;
+            bestR1 = r1;
+            std::copy(indices, indices + 16, bestIndices);
+        }
+        };
+
+    // 8-value mode over the full range, refined by least squares.
+    if (hi > lo) {
+        int r0 = hi, r1 = lo;
+        consider(r0, r1);
+        for (int pass = 0; pass < 2; ++pass) {
+            TryEndpoints(texels, r0, r1, indices);
+            if (!RefineEndpoints(texels, indices, r0, r1)) break;
+            consider(r0, r1);
+        }
+    }
+    // 6-value mode: exact 0 / 255 texels come for free, the palette spans the rest.
+    if (innerHi >= innerLo) consider(innerLo, innerHi);
+
+    PackBC4(bestR0, bestR1, bestIndices, out);
+}
+
+void DecodeBC4Block(const unsigned char block[8], unsigned char texels[16]) {
+    int palette[8];
+    BC4Palette(block[0], block[1], palette);
+    uint64_t bits = 0;
+    for (int b = 0; b < 6; ++b) bits |= (uint64_t)block[2 + b] << (8 * b);
+    for (int t = 0; t < 16; ++t) texels[t] = (unsigned char)palette[(bits >> (3 * t)) & 7];
+}
+
+std::vector<unsigned char> CompressVolume(VolumeHeader& header, const unsigned char* data, VolumeFormat format,
+    uint32_t firstChannel, ThreadPool* pool) {
+    if (IsBlockCompressed(header.format)) throw std::runtime_error("volume is already block compressed");
+    if (format != VolumeFormat::BC4 && format != VolumeFormat::BC5) throw std::runtime_error("not a block format");
+    const uint32_t outChannels = format == VolumeFormat::BC4 ? 1 : 2;
+    if (firstChannel + outChannels > header.channels) throw std::runtime_error("volume has too few channels");
+
+    VolumeHeader out = header;
+    out.format = (uint32_t)format;
+    out.channels = outChannels;
+
+    std::unique_ptr<ThreadPool> ownPool;
+    if (!pool) {
+        ownPool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        pool = ownPool.get();
+    }
+
+    size_t total = 0;
+    for (uint32_t level = 0; level < header.mipCount; ++level) total += VolumeLevelSize(out, level);
+    std::vector<unsigned char> blocks(total);
+
+    std::vector<std::future<void>> jobs;
+    size_t srcOffset = 0, dstOffset = 0;
+    for (uint32_t level = 0; level < header.mipCount; ++level) {
+        const uint32_t w = std::max(1u, header.width >> level);
+        const uint32_t h = std::max(1u, header.height >> level);
+        const uint32_t d = std::max(1u, header.depth >> level);
+        const uint32_t bw = (w + 3) / 4, bh = (h + 3) / 4;
+        const unsigned char* src = data + srcOffset;
+        unsigned char* dst = blocks.data() + dstOffset;
+        const uint32_t channels = header.channels;
+
+        // One job per band of block rows; rows of all slices are independent.
+        const uint32_t rows = bh * d;
+        const uint32_t bands = std::min(rows, pool->size() * 4);
+        for (uint32_t band = 0; band < bands; ++band) {
+            const uint32_t row0 = rows * band / bands, row1 = rows * (band + 1) / bands;
+            jobs.push_back(pool->submit([=] {
+                unsigned char texels[16];
+                for (uint32_t row = row0; row < row1; ++row) {
+                    const uint32_t z = row / bh, by = row % bh;
+                    for (uint32_t bx = 0; bx < bw; ++bx) {
+                        unsigned char* block = dst + ((size_t)row * bw + bx) * BlockBytes(format);
+                        for (uint32_t c = 0; c < outChannels; ++c) {
+                            for (uint32_t t = 0; t < 16; ++t) {
+                                const uint32_t x = std::min(w - 1, bx * 4 + (t & 3));
+                                const uint32_t y = std::min(h - 1, by * 4 + (t >> 2));
+                                texels[t] = src[(((size_t)z * h + y) * w + x) * channels + firstChannel + c];
+                            }
+                            EncodeBC4Block(texels, block + c * 8);
+                        }
+                    }
+                }
+            }));
+        }
+
+        srcOffset += VolumeLevelSize(header, level);
+        dstOffset += VolumeLevelSize(out, level);
+    }
+    for (auto& job : jobs) job.get();
+
+    header = out;
+    return blocks;
+}
+
+std::vector<unsigned char> DecompressVolume(VolumeHeader& header, const unsigned char* data) {
+    if (!IsBlockCompressed(header.format)) throw std::runtime_error("volume is not block compressed");
+
+    VolumeHeader out = header;
+    const uint32_t channels = header.format == (uint32_t)VolumeFormat::BC4 ? 1 : 2;
+    out.format = channels == 1 ? (uint32_t)VolumeFormat::R8 : (uint32_t)VolumeFormat::RG8;
+    out.channels = channels;
+
+    std::vector<unsigned char> texels;
+    size_t srcOffset = 0;
+    for (uint32_t level = 0; level < header.mipCount; ++level) {
+        const uint32_t w = std::max(1u, header.width >> level);
+        const uint32_t h = std::max(1u, header.height >> level);
+        const uint32_t d = std::max(1u, header.depth >> level);
+        const uint32_t bw = (w + 3) / 4, bh = (h + 3) / 4;
+        const size_t base = texels.size();
+        texels.resize(base + VolumeLevelSize(out, level));
+
+        unsigned char decoded[16];
+        for (uint32_t z = 0; z < d; ++z)
+            for (uint32_t by = 0; by < bh; ++by)
+                for (uint32_t bx = 0; bx < bw; ++bx) {
+                    const unsigned char* block = data + srcOffset + (((size_t)z * bh + by) * bw + bx) * channels * 8;
+                    for (uint32_t c = 0; c < channels; ++c) {
+                        DecodeBC4Block(block + c * 8, decoded);
+                        for (uint32_t t = 0; t < 16; ++t) {
+                            const uint32_t x = bx * 4 + (t & 3), y = by * 4 + (t >> 2);
+                            if (x < w && y < h) texels[base + (((size_t)z * h + y) * w + x) * channels + c] = decoded[t];
+                        }
+                    }
+                }
+        srcOffset += VolumeLevelSize(header, level);
+    }
+
+    header = out;
+    return texels;
+}
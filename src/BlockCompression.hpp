@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "VolumeFile.hpp"
+
+class ThreadPool;
+
+// RGTC block coding: BC4 stores one 8-bit channel in 8 bytes per 4x4 block, BC5 two
+// channels as a pair of BC4 blocks. Blocks past the right/bottom edge replicate the
+// last column/row.
+
+void EncodeBC4Block(const unsigned char texels[16], unsigned char out[8]);
+void DecodeBC4Block(const unsigned char block[8], unsigned char texels[16]);
+
+// Compresses every level of an uncompressed volume (any channel count) into BC4
+// (channel `firstChannel`) or BC5 (channels firstChannel, firstChannel + 1). Block rows
+// of all slices are spread over `pool` (a temporary pool when null). `header` is
+// rewritten to describe the result.
+std::vector<unsigned char> CompressVolume(VolumeHeader& header, const unsigned char* data, VolumeFormat format,
+    uint32_t firstChannel = 0, ThreadPool* pool = nullptr);
+
+// Expands BC4/BC5 levels back to R8/RG8; `header` is rewritten likewise.
+std::vector<unsigned char> DecompressVolume(VolumeHeader& header, const unsigned char* data);
@@ -0,0 +1,60 @@
+#include "FrameUniforms.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+FrameUniformBuffer::FrameUniformBuffer(GLuint bindingPoint) : binding(bindingPoint) {
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    if (align <= 0) align = 256;
+
+    slotStride = ((GLsizeiptr)sizeof(FrameData) + align - 1) / align * align;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferStorage(GL_UNIFORM_BUFFER, slotStride * kSlots, nullptr, flags);
+    mapped = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, slotStride * kSlots, flags));
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    if (!mapped) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        throw std::runtime_error("Failed to map FrameData uniform buffer");
+    }
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+    for (GLsync& f : fences) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    if (buffer) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+void FrameUniformBuffer::update(const FrameData& data) {
+    // Everything that read the previous slot has been submitted by now.
+    if (slot >= 0) {
+        if (fences[slot]) glDeleteSync(fences[slot]);
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    slot = (slot + 1) % kSlots;
+
+    if (fences[slot]) {
+        // Normally already signalled: the slot was last used kSlots frames ago.
+        while (glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(fences[slot]);
+        fences[slot] = nullptr;
+    }
+
+    std::memcpy(mapped + slot * slotStride, &data, sizeof(FrameData));
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, slot * slotStride, sizeof(FrameData));
+}
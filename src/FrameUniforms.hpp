@@ -0,0 +1,88 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// Binding point of the FrameData block. Every program that declares the block gets it
+// assigned at link time (see Shader::setUniformBlockBinding).
+constexpr GLuint kFrameDataBinding = 0;
+
+// Mirrors `layout(std140) uniform FrameData` in shaders/. Each vec3 is followed by a
+// float so the C++ packing matches std140 without explicit padding.
+struct FrameData {
+    glm::vec3 cameraPosition;
+    float time;
+
+    glm::vec3 cameraFront;
+    float screenWidth;
+
+    glm::vec3 cameraUp;
+    float screenHeight;
+
+    glm::vec3 cameraRight;
+    float cloudBottom;
+
+    glm::vec3 earthCenter;
+    float cloudTop;
+
+    glm::vec2 jitter;
+    glm::vec2 resolution;
+
+    // previous frame's camera, for reprojection
+    glm::vec3 prevCameraPosition;
+    float pad0;
+    glm::vec3 prevCameraFront;
+    float pad1;
+    glm::vec3 prevCameraUp;
+    float pad2;
+    glm::vec3 prevCameraRight;
+    float pad3;
+};
+
+static_assert(offsetof(FrameData, cameraPosition) == 0, "FrameData.cameraPosition offset");
+static_assert(offsetof(FrameData, time) == 12, "FrameData.Time offset");
+static_assert(offsetof(FrameData, cameraFront) == 16, "FrameData.cameraFront offset");
+static_assert(offsetof(FrameData, screenWidth) == 28, "FrameData.screenWidth offset");
+static_assert(offsetof(FrameData, cameraUp) == 32, "FrameData.cameraUp offset");
+static_assert(offsetof(FrameData, screenHeight) == 44, "FrameData.screenHeight offset");
+static_assert(offsetof(FrameData, cameraRight) == 48, "FrameData.cameraRight offset");
+static_assert(offsetof(FrameData, cloudBottom) == 60, "FrameData.CloudBottom offset");
+static_assert(offsetof(FrameData, earthCenter) == 64, "FrameData.EarthCenter offset");
+static_assert(offsetof(FrameData, cloudTop) == 76, "FrameData.CloudTop offset");
+static_assert(offsetof(FrameData, jitter) == 80, "FrameData.HaltonSequence offset");
+static_assert(offsetof(FrameData, resolution) == 88, "FrameData.resolution offset");
+static_assert(offsetof(FrameData, prevCameraPosition) == 96, "FrameData.prevCameraPosition offset");
+static_assert(offsetof(FrameData, prevCameraFront) == 112, "FrameData.prevCameraFront offset");
+static_assert(offsetof(FrameData, prevCameraUp) == 128, "FrameData.prevCameraUp offset");
+static_assert(offsetof(FrameData, prevCameraRight) == 144, "FrameData.prevCameraRight offset");
+static_assert(sizeof(FrameData) == 160, "FrameData must match the std140 block size");
+static_assert(sizeof(FrameData) % 16 == 0, "std140 blocks are padded to vec4");
+
+// Ring of FrameData slots in one persistently mapped buffer. A slot is only rewritten
+// after the fence placed behind the frame that last read it has signalled.
+class FrameUniformBuffer {
+public:
+    static constexpr int kSlots = 3;
+
+    explicit FrameUniformBuffer(GLuint binding = kFrameDataBinding);
+    ~FrameUniformBuffer();
+
+    FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+    FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+    // Writes the frame's data into the next slot and binds it to the block binding.
+    void update(const FrameData& data);
+
+    GLuint getBuffer() const { return buffer; }
+
+private:
+    GLuint binding = kFrameDataBinding;
+    GLuint buffer = 0;
+    GLsizeiptr slotStride = 0;
+    uint8_t* mapped = nullptr;
+
+    GLsync fences[kSlots] = {};
+    int slot = -1;
+};
@@ -0,0 +1,45 @@
+#include "GLLoader.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+GLLoader::GLLoader(GLFWwindow* loaderContext) : context(loaderContext) {
+    if (!context) throw std::runtime_error("no shared loader context");
+    thread = std::thread([this] { run(); });
+}
+
+GLLoader::~GLLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (thread.joinable()) thread.join();
+
+    while (!tasks.empty()) {
+        tasks.front()(true);
+        tasks.pop();
+    }
+}
+
+void GLLoader::run() {
+    glfwMakeContextCurrent(context);
+    for (;;) {
+        std::function<void(bool)> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) break;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task(false);
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+void GLLoader::publish() {
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+    glDeleteSync(fence);
+}
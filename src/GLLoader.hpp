@@ -0,0 +1,71 @@
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+// Background thread owning a hidden GLFW context that shares objects with the render
+// context (see Window::getLoaderContext). Tasks create textures, buffers and programs there.
+// A task's future only becomes ready after a glFenceSync placed behind its commands has
+// signalled, so the render thread never sees a half-uploaded object. Programs may still be
+// linking in the driver (KHR_parallel_shader_compile); poll their completion status.
+// Container objects (VAOs, FBOs, program pipelines) are not shared and stay on the render thread.
+class GLLoader {
+public:
+    // Takes over `context` for the loader thread; throws when it is null.
+    explicit GLLoader(GLFWwindow* context);
+    // Finishes the running task; tasks still queued are cancelled.
+    ~GLLoader();
+
+    GLLoader(const GLLoader&) = delete;
+    GLLoader& operator=(const GLLoader&) = delete;
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto promise = std::make_shared<std::promise<Result>>();
+        auto job = std::make_shared<std::decay_t<F>>(std::forward<F>(task));
+        std::future<Result> result = promise->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([promise, job](bool cancelled) {
+                if (cancelled) {
+                    promise->set_exception(std::make_exception_ptr(std::runtime_error("GL loader shut down")));
+                    return;
+                }
+                try {
+                    Result value = (*job)();
+                    publish();
+                    promise->set_value(std::move(value));
+                }
+                catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+        wake.notify_one();
+        return result;
+    }
+
+private:
+    void run();
+    // Fences the task's commands and waits for them on this thread.
+    static void publish();
+
+    GLFWwindow* context = nullptr;
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Called with true when the loader stops before reaching the task: its future then
+    // holds a "shut down" error instead of a broken promise.
+    std::queue<std::function<void(bool cancelled)>> tasks;
+    bool stopping = false;
+    std::thread thread;
+};
@@ -0,0 +1,169 @@
+#include "GLState.hpp"
+
+GLState& GLState::get() {
+    // Each thread here drives exactly one context (render thread, GLLoader thread).
+    thread_local GLState state;
+    return state;
+}
+
+int GLState::capIndex(GLenum cap) {
+    switch (cap) {
+    case GL_BLEND: return 0;
+    case GL_DEPTH_TEST: return 1;
+    case GL_CULL_FACE: return 2;
+    case GL_SCISSOR_TEST: return 3;
+    case GL_STENCIL_TEST: return 4;
+    case GL_DITHER: return 5;
+    default: return -1;
+    }
+}
+
+void GLState::useProgram(GLuint value) {
+    if (changed(program != value)) {
+        glUseProgram(value);
+        program = value;
+    }
+}
+
+void GLState::bindProgramPipeline(GLuint value) {
+    if (changed(pipeline != value)) {
+        glBindProgramPipeline(value);
+        pipeline = value;
+    }
+}
+
+void GLState::bindFramebuffer(GLuint value) {
+    if (changed(framebuffer != value)) {
+        glBindFramebuffer(GL_FRAMEBUFFER, value);
+        framebuffer = value;
+    }
+}
+
+void GLState::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (changed(view[0] != x || view[1] != y || view[2] != width || view[3] != height)) {
+        glViewport(x, y, width, height);
+        view[0] = x;
+        view[1] = y;
+        view[2] = width;
+        view[3] = height;
+    }
+}
+
+void GLState::setEnabled(GLenum cap, bool enabled) {
+    const int index = capIndex(cap);
+    if (index >= 0 && !changed(caps[index] != (int8_t)enabled)) return;
+    if (index < 0) ++current.issued;
+
+    if (enabled) glEnable(cap);
+    else glDisable(cap);
+    if (index >= 0) caps[index] = (int8_t)enabled;
+}
+
+void GLState::depthMask(bool enabled) {
+    if (changed(depthWrite != (int8_t)enabled)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+        depthWrite = (int8_t)enabled;
+    }
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst) {
+    if (changed(blendSrc != src || blendDst != dst)) {
+        glBlendFunc(src, dst);
+        blendSrc = src;
+        blendDst = dst;
+    }
+}
+
+void GLState::clearColor(float r, float g, float b, float a) {
+    if (changed(clear[0] != r || clear[1] != g || clear[2] != b || clear[3] != a)) {
+        glClearColor(r, g, b, a);
+        clear[0] = r;
+        clear[1] = g;
+        clear[2] = b;
+        clear[3] = a;
+    }
+}
+
+void GLState::bindTexture(GLuint unit, GLuint texture) {
+    if (unit >= (GLuint)kMaxTextureUnits) {
+        ++current.issued;
+        glBindTextureUnit(unit, texture);
+        return;
+    }
+    if (changed(textures[unit] != texture)) {
+        glBindTextureUnit(unit, texture);
+        textures[unit] = texture;
+    }
+}
+
+void GLState::bindTextures(GLuint first, GLsizei count, const GLuint* names) {
+    if (first + (GLuint)count > (GLuint)kMaxTextureUnits) {
+        ++current.issued;
+        glBindTextures(first, count, names);
+        return;
+    }
+    bool differs = false;
+    for (GLsizei i = 0; i < count; ++i) differs |= textures[first + i] != names[i];
+    if (changed(differs)) {
+        glBindTextures(first, count, names);
+        for (GLsizei i = 0; i < count; ++i) textures[first + i] = names[i];
+    }
+}
+
+void GLState::bindSamplers(GLuint first, GLsizei count, const GLuint* names) {
+    if (first + (GLuint)count > (GLuint)kMaxTextureUnits) {
+        ++current.issued;
+        glBindSamplers(first, count, names);
+        return;
+    }
+    bool differs = false;
+    for (GLsizei i = 0; i < count; ++i) differs |= samplers[first + i] != names[i];
+    if (changed(differs)) {
+        glBindSamplers(first, count, names);
+        for (GLsizei i = 0; i < count; ++i) samplers[first + i] = names[i];
+    }
+}
+
+void GLState::programDeleted(GLuint value) {
+    // A deleted program that is still current stays bound until replaced.
+    if (program == value) program = kUnknown;
+}
+
+void GLState::pipelineDeleted(GLuint value) {
+    if (pipeline == value) pipeline = 0;
+}
+
+void GLState::framebufferDeleted(GLuint value) {
+    if (framebuffer == value) framebuffer = 0;
+}
+
+void GLState::textureDeleted(GLuint texture) {
+    for (GLuint& bound : textures) {
+        if (bound == texture) bound = 0;
+    }
+}
+
+void GLState::samplerDeleted(GLuint sampler) {
+    for (GLuint& bound : samplers) {
+        if (bound == sampler) bound = 0;
+    }
+}
+
+void GLState::invalidate() {
+    program = kUnknown;
+    pipeline = kUnknown;
+    framebuffer = kUnknown;
+    for (GLint& v : view) v = -1;
+    for (int8_t& c : caps) c = -1;
+    depthWrite = -1;
+    blendSrc = GL_NONE;
+    blendDst = GL_NONE;
+    for (float& c : clear) c = -1.0f;
+    for (GLuint& t : textures) t = kUnknown;
+    for (GLuint& s : samplers) s = kUnknown;
+}
+
+void GLState::beginFrame() {
+    lastFrame = current;
+    current = Counters{};
+}
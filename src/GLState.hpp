@@ -0,0 +1,79 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <cstdint>
+
+// Shadow copy of the GL state the renderer changes every frame. Each setter forwards
+// to GL only when the value differs from the cached one, and counts issued vs elided
+// calls. One instance per context, i.e. per thread (get() is thread_local): after code
+// that changes this state behind the tracker's back (third-party code), call invalidate().
+class GLState {
+public:
+    static constexpr int kMaxTextureUnits = 16;
+
+    struct Counters {
+        uint32_t issued = 0;
+        uint32_t elided = 0;
+    };
+
+    static GLState& get();
+
+    void useProgram(GLuint program);
+    void bindProgramPipeline(GLuint pipeline);
+    void bindFramebuffer(GLuint framebuffer);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void setEnabled(GLenum cap, bool enabled);
+    void depthMask(bool enabled);
+    void blendFunc(GLenum src, GLenum dst);
+    void clearColor(float r, float g, float b, float a);
+    // glBindTextureUnit: no active-unit selector involved.
+    void bindTexture(GLuint unit, GLuint texture);
+    // One glBindTextures / glBindSamplers call for a run of units, issued only if any differs.
+    void bindTextures(GLuint first, GLsizei count, const GLuint* textures);
+    void bindSamplers(GLuint first, GLsizei count, const GLuint* samplers);
+
+    // Deleting an object changes bindings implicitly; keep the cache in sync.
+    void programDeleted(GLuint program);
+    void pipelineDeleted(GLuint pipeline);
+    void framebufferDeleted(GLuint framebuffer);
+    void textureDeleted(GLuint texture);
+    void samplerDeleted(GLuint sampler);
+
+    // Forget everything; the next call of each setter is always issued.
+    void invalidate();
+
+    // Starts a new counting period; the finished one is kept in getLastFrame().
+    void beginFrame();
+    const Counters& getLastFrame() const { return lastFrame; }
+    const Counters& getCurrentFrame() const { return current; }
+
+private:
+    GLState() { invalidate(); }
+
+    // Caps the tracker knows about; anything else is forwarded and counted as issued.
+    static int capIndex(GLenum cap);
+    static constexpr int kTrackedCaps = 6;
+
+    bool changed(bool differs) {
+        if (differs) ++current.issued;
+        else ++current.elided;
+        return differs;
+    }
+
+    static constexpr GLuint kUnknown = 0xFFFFFFFFu;
+
+    GLuint program = kUnknown;
+    GLuint pipeline = kUnknown;
+    GLuint framebuffer = kUnknown;
+    GLint view[4] = { -1, -1, -1, -1 };
+    int8_t caps[kTrackedCaps];
+    int8_t depthWrite = -1;
+    GLenum blendSrc = GL_NONE;
+    GLenum blendDst = GL_NONE;
+    float clear[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+    GLuint textures[kMaxTextureUnits];
+    GLuint samplers[kMaxTextureUnits];
+
+    Counters current;
+    Counters lastFrame;
+};
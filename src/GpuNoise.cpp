@@ -0,0 +1,87 @@
+#include "GpuNoise.hpp"
+#include "VolumeFile.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    bool IsPowerOfTwo(uint32_t size) { return size >= 4 && (size & (size - 1)) == 0; }
+}
+
+GpuNoise::GpuNoise(const std::string& volumeShaderPath, const std::string& curlShaderPath) {
+    if (!GLEW_VERSION_4_3 && !GLEW_ARB_compute_shader) {
+        throw std::runtime_error("compute shaders are not supported");
+    }
+
+    volumeProgram = std::make_unique<Shader>(volumeShaderPath.c_str());
+    curlProgram = std::make_unique<Shader>(curlShaderPath.c_str());
+
+    volumeSize = volumeProgram->uniform<int>("volumeSize");
+    volumeSeed = volumeProgram->uniform<unsigned int>("noiseSeed");
+    lowFrequency = volumeProgram->uniform<bool>("lowFrequency");
+    curlSize = curlProgram->uniform<int>("textureSize");
+    curlSeed = curlProgram->uniform<unsigned int>("noiseSeed");
+}
+
+std::unique_ptr<Texture> GpuNoise::generateVolume(const NoiseGenerator::Settings& settings) {
+    if (!IsPowerOfTwo(settings.size)) return nullptr;
+
+    auto texture = std::make_unique<Texture>(NoiseGenerator::VolumeName(settings.volume));
+    if (!texture->CreateStorage3D((GLsizei)settings.size, GL_RGBA8)) return nullptr;
+
+    volumeSize.set((int)settings.size);
+    volumeSeed.set(settings.seed);
+    lowFrequency.set(settings.volume == NoiseGenerator::Volume::LowFrequency);
+
+    glBindImageTexture(0, texture->GetID(), 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    const GLuint groups = (settings.size + 3) / 4;
+    volumeProgram->dispatchCompute(groups, groups, groups);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    // level 0 was written by the shader; the rest of the chain is a driver downsample
+    glGenerateTextureMipmap(texture->GetID());
+    return texture;
+}
+
+std::unique_ptr<Texture> GpuNoise::generateCurl(uint32_t size, uint32_t seed) {
+    if (!IsPowerOfTwo(size)) return nullptr;
+
+    auto texture = std::make_unique<Texture>("curl");
+    if (!texture->CreateStorage2D((GLsizei)size, (GLsizei)size, GL_RGBA8)) return nullptr;
+
+    curlSize.set((int)size);
+    curlSeed.set(seed);
+
+    glBindImageTexture(0, texture->GetID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    const GLuint groups = (size + 7) / 8;
+    curlProgram->dispatchCompute(groups, groups, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    return texture;
+}
+
+std::vector<unsigned char> GpuNoise::readBack(const Texture& texture, size_t bytes) {
+    std::vector<unsigned char> texels(bytes);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(texture.GetID(), 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)bytes, texels.data());
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    return texels;
+}
+
+GpuNoise::Comparison GpuNoise::compare(const std::vector<unsigned char>& gpu, const std::vector<unsigned char>& cpu) {
+    Comparison result;
+    result.gpuChecksum = VolumeChecksum(gpu.data(), gpu.size());
+    result.cpuChecksum = VolumeChecksum(cpu.data(), cpu.size());
+    if (gpu.size() != cpu.size()) {
+        result.maxDifference = 255;
+        result.differingBytes = std::max(gpu.size(), cpu.size());
+        return result;
+    }
+    for (size_t i = 0; i < gpu.size(); ++i) {
+        const int diff = std::abs((int)gpu[i] - (int)cpu[i]);
+        if (diff) ++result.differingBytes;
+        result.maxDifference = std::max(result.maxDifference, diff);
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NoiseGenerator.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+// Generates the cloud noise textures with compute shaders (shaders/noise_volume.comp,
+// shaders/noise_curl.comp) straight into immutable storage: no decode, no disk I/O,
+// and any power-of-two resolution. The shaders mirror NoiseGenerator, which serves as
+// the CPU reference for compare().
+class GpuNoise {
+public:
+    struct Resolution {
+        uint32_t lowFrequency = 128;
+        uint32_t highFrequency = 32;
+        uint32_t curl = 128;
+    };
+
+    // Checksums are VolumeChecksum over the RGBA8 texels.
+    struct Comparison {
+        uint64_t gpuChecksum = 0;
+        uint64_t cpuChecksum = 0;
+        int maxDifference = 0;
+        size_t differingBytes = 0;
+
+        // GPU float math (sqrt, division, unorm rounding) may land one step off the CPU.
+        bool matches(int tolerance = 1) const { return maxDifference <= tolerance; }
+    };
+
+    // Throws std::runtime_error without compute shader support or if a program fails to build.
+    GpuNoise(const std::string& volumeShaderPath, const std::string& curlShaderPath);
+
+    // Return null on invalid sizes. Issue the dispatch only; the driver orders later sampling.
+    std::unique_ptr<Texture> generateVolume(const NoiseGenerator::Settings& settings);
+    std::unique_ptr<Texture> generateCurl(uint32_t size, uint32_t seed);
+
+    // Synchronous RGBA8 readback of level 0.
+    static std::vector<unsigned char> readBack(const Texture& texture, size_t bytes);
+    static Comparison compare(const std::vector<unsigned char>& gpu, const std::vector<unsigned char>& cpu);
+
+private:
+    std::unique_ptr<Shader> volumeProgram;
+    std::unique_ptr<Shader> curlProgram;
+
+    Uniform<int> volumeSize;
+    Uniform<unsigned int> volumeSeed;
+    Uniform<bool> lowFrequency;
+    Uniform<int> curlSize;
+    Uniform<unsigned int> curlSeed;
+};
@@ -1,9 +1,14 @@
 #include "Init.hpp"
+#include "GLState.hpp"
+#include "NoiseGenerator.hpp"
+#include "GpuNoise.hpp"
 
 #include <array>
+#include <chrono>
 #include <algorithm>
 #include <cmath>
 #include <filesystem>
+#include <functional>
 #include <initializer_list>
 #include <stdexcept>
 #include <string>
@@ -26,6 +31,10 @@
 
 namespace {
     constexpr float kEarthRadius = 6378000.0f;
+    // CAMERA_FOCAL_LENGTH in shaders/include/common.glsl
+    constexpr float kCameraFocalLength = 1.6f;
+    // view distance for "nothing there" (OCEAN_NO_HIT in shaders/include/ocean.glsl)
+    constexpr float kFarDistance = 1e7f;
 
     static std::filesystem::path GetExeDir() {
 #ifdef _WIN32
@@ -42,7 +51,8 @@ namespace {
 #endif
     }
 
-    static std::string FindInRoots(const char* folder, const char* name) {
+    // exe dir and cwd, each followed by up to 9 parents
+    static std::vector<std::filesystem::path> SearchRoots() {
         namespace fs = std::filesystem;
 
         fs::path exe = GetExeDir();
@@ -69,8 +79,22 @@ namespace {
             if (!p.has_parent_path()) break;
             p = p.parent_path();
         }
+        return roots;
+    }
+
+    // Directory the last hot-reloaded shader edit came from; searched before the usual roots.
+    static std::filesystem::path& PreferredShaderRoot() {
+        static std::filesystem::path root;
+        return root;
+    }
+
+    static std::string FindInRoots(const char* folder, const char* name) {
+        namespace fs = std::filesystem;
+
+        fs::path exe = GetExeDir();
+        fs::path cwd = fs::current_path();
 
-        for (const auto& r : roots) {
+        for (const auto& r : SearchRoots()) {
             fs::path cand = r / folder / name;
             if (fs::exists(cand) && fs::is_regular_file(cand)) return cand.string();
         }
@@ -88,62 +112,66 @@ namespace {
         );
     }
 
-    static std::string FindShaderFile(const char* name) { return FindInRoots("shaders", name); }
-    static std::string FindTextureFile(const char* name) { return FindInRoots("textures", name); }
-
-    static GLint GetLocAny(GLuint program, std::initializer_list<const char*> names) {
-        for (const char* n : names) {
-            GLint loc = glGetUniformLocation(program, n);
-            if (loc != -1) return loc;
-        }
-        return -1;
-    }
-
-    static void Set1fAny(GLuint program, float v, std::initializer_list<const char*> names) {
-        GLint loc = GetLocAny(program, names);
-        if (loc != -1) glUniform1f(loc, v);
+    static std::string FindShaderFile(const char* name) {
+        const std::filesystem::path& preferred = PreferredShaderRoot();
+        if (!preferred.empty() && std::filesystem::is_regular_file(preferred / name)) return (preferred / name).string();
+        return FindInRoots("shaders", name);
     }
 
-    static void Set2fAny(GLuint program, float x, float y, std::initializer_list<const char*> names) {
-        GLint loc = GetLocAny(program, names);
-        if (loc != -1) glUniform2f(loc, x, y);
+    // Every existing shaders/ directory under the search roots, e.g. the copy next to the
+    // executable and the one in the source tree.
+    static std::vector<std::filesystem::path> ShaderRoots() {
+        std::vector<std::filesystem::path> dirs;
+        for (const auto& r : SearchRoots()) {
+            std::filesystem::path dir = (r / "shaders").lexically_normal();
+            if (std::filesystem::is_directory(dir) && std::find(dirs.begin(), dirs.end(), dir) == dirs.end()) dirs.push_back(dir);
+        }
+        return dirs;
     }
 
-    static void Set3fAny(GLuint program, const glm::vec3& v, std::initializer_list<const char*> names) {
-        GLint loc = GetLocAny(program, names);
-        if (loc != -1) glUniform3f(loc, v.x, v.y, v.z);
+    // Path of a loaded shader file below whichever shaders/ root contains it, or "" if none does.
+    static std::string ShaderRelativePath(const std::string& file, const std::vector<std::filesystem::path>& roots) {
+        const std::filesystem::path normalized = std::filesystem::path(file).lexically_normal();
+        for (const auto& root : roots) {
+            std::filesystem::path rel = normalized.lexically_relative(root);
+            if (!rel.empty() && *rel.begin() != "..") return rel.generic_string();
+        }
+        return "";
     }
+    static std::string FindTextureFile(const char* name) { return FindInRoots("textures", name); }
 
-    static void SetMat4Any(GLuint program, const glm::mat4& m, std::initializer_list<const char*> names) {
-        GLint loc = GetLocAny(program, names);
-        if (loc != -1) glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(m));
+    // glProgramUniform so this works for programs used through a pipeline.
+    // Goes through GLState, so repeating it every pass costs nothing once the state matches.
+    static void ResetFullscreenState(int w, int h, GLuint fbo = 0) {
+        GLState& gl = GLState::get();
+        gl.bindFramebuffer(fbo);
+        gl.viewport(0, 0, w, h);
+        gl.setEnabled(GL_SCISSOR_TEST, false);
+        gl.setEnabled(GL_STENCIL_TEST, false);
+        gl.setEnabled(GL_CULL_FACE, false);
+        gl.setEnabled(GL_DEPTH_TEST, false);
+        gl.setEnabled(GL_BLEND, false);
+        gl.depthMask(false);
     }
 
-    static void Bind2D(Texture& tex, Shader& sh, std::initializer_list<const char*> names, GLint unit) {
-        GLint loc = GetLocAny(sh.ID, names);
-        if (loc != -1) tex.UseTexture(loc, unit);
+    static void ClearColorOnly() {
+        GLState::get().clearColor(0.f, 0.f, 0.f, 1.f);
+        glClear(GL_COLOR_BUFFER_BIT);
     }
 
-    static void Bind3D(Texture& tex, Shader& sh, std::initializer_list<const char*> names, GLint unit) {
-        GLint loc = GetLocAny(sh.ID, names);
-        if (loc != -1) tex.UseTexture3D(loc, unit);
+    static void ClearTransparent() {
+        GLState::get().clearColor(0.f, 0.f, 0.f, 0.f);
+        glClear(GL_COLOR_BUFFER_BIT);
     }
 
-    static void ResetFullscreenState(int w, int h) {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glViewport(0, 0, w, h);
-        glDisable(GL_SCISSOR_TEST);
-        glDisable(GL_STENCIL_TEST);
-        glDisable(GL_CULL_FACE);
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
-        glDepthMask(GL_FALSE);
-    }
+    // Profiler zone + dynamic-resolution timing of one pass.
+    struct PassScope {
+        PassScope(Profiler* profiler, ResolutionGovernor* governor, const char* name)
+            : zone(profiler, name), timer(governor, name) {}
 
-    static void ClearColorOnly() {
-        glClearColor(0.f, 0.f, 0.f, 1.f);
-        glClear(GL_COLOR_BUFFER_BIT);
-    }
+        ProfileZone zone;
+        GpuPassScope timer;
+    };
 
     static void DebugPrintPath(const char* tag, const std::string& p) {
         std::fprintf(stderr, "[%s] %s\n", tag, p.c_str());
@@ -170,6 +198,11 @@ Init::Init() : Window() {
 
 Init::~Init() {
     destroyTaaTargets();
+    destroyUpscaleTarget();
+    destroyCloudTargets();
+    destroyCloudHistory();
+    destroySamplers();
+    Shader::setBinaryCache(nullptr);
 }
 
 void Init::calcAverageNormals(
@@ -262,13 +295,15 @@ glm::vec2 Init::Halton2D(int frameIndex) {
 void Init::initialize() {
     glfwSwapInterval(1);
 
-    glDisable(GL_DITHER);
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_SCISSOR_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
+    GLState& gl = GLState::get();
+    gl.invalidate();
+    gl.setEnabled(GL_DITHER, false);
+    gl.setEnabled(GL_BLEND, false);
+    gl.setEnabled(GL_CULL_FACE, false);
+    gl.setEnabled(GL_SCISSOR_TEST, false);
+    gl.setEnabled(GL_STENCIL_TEST, false);
+    gl.setEnabled(GL_DEPTH_TEST, false);
+    gl.depthMask(false);
 
     lastX = getWindowWidth() * 0.5f;
     lastY = getWindowHeight() * 0.5f;
@@ -296,83 +331,731 @@ void Init::initialize() {
 
     glfwSetInputMode(getWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-    const std::string vtx = FindShaderFile("vertex.glsl");
-    DebugPrintPath("shader.vs", vtx);
+    Shader::setUniformBlockBinding("FrameData", kFrameDataBinding);
+    try {
+        frameUniforms = std::make_unique<FrameUniformBuffer>(kFrameDataBinding);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "FrameData buffer init failed: %s\n", e.what());
+        frameUniforms.reset();
+    }
+
+    programCache = std::make_unique<ProgramBinaryCache>(GetExeDir() / "shader_cache");
+    Shader::setBinaryCache(programCache->isEnabled() ? programCache.get() : nullptr);
 
-    auto tryLoad = [&](std::unique_ptr<Shader>& dst, const char* frag) {
+    const bool parallel = Shader::enableParallelCompile();
+    std::fprintf(stderr, "[shaders] parallel compile: %s\n", parallel ? "yes" : "no (builds finish on first poll)");
+
+    if (getLoaderContext()) {
         try {
-            const std::string fs = FindShaderFile(frag);
-            DebugPrintPath("shader.fs", fs);
-            dst = std::make_unique<Shader>(vtx.c_str(), fs.c_str());
+            loader = std::make_unique<GLLoader>(getLoaderContext());
+            std::fprintf(stderr, "[loader] programs and textures load on a shared-context thread\n");
         }
         catch (const std::exception& e) {
-            std::fprintf(stderr, "Shader load failed (%s): %s\n", frag, e.what());
-            dst.reset();
+            std::fprintf(stderr, "[loader] unavailable, loading on the render thread: %s\n", e.what());
         }
-        };
+    }
 
-    tryLoad(shader, "fragment.glsl");
-    tryLoad(fragmentv2, "fragmentv2.glsl");
-    tryLoad(rmarching, "RayMarchingFragment.glsl");
-    tryLoad(rmarching2, "RayMarching2.glsl");
-    tryLoad(singlecloudfrag, "singlecloudfrag.glsl");
-    tryLoad(water, "waterfrag.glsl");
-    tryLoad(watersky, "waterskyfrag.glsl");
-    tryLoad(cloudsOver, "clouds_over.glsl");
+    if (!profiler) profiler = std::make_unique<Profiler>();
 
-    try {
-        const std::string tv = FindShaderFile("ttavert.glsl");
-        const std::string tf = FindShaderFile("ttafrag.glsl");
-        DebugPrintPath("shader.taa.vs", tv);
-        DebugPrintPath("shader.taa.fs", tf);
-        taaShader = std::make_unique<Shader>(tv.c_str(), tf.c_str());
+    if (!governor) {
+        double budget = frameBudgetMs;
+        if (budget <= 0.0) {
+            const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+            const int hz = mode && mode->refreshRate > 0 ? mode->refreshRate : 60;
+            // Headroom for the CPU side and the compositor.
+            budget = 0.9 * 1000.0 / hz;
+        }
+        governor = std::make_unique<ResolutionGovernor>(budget);
+        std::fprintf(stderr, "[resolution] GPU budget %.1f ms per frame\n", governor->getBudget());
     }
-    catch (...) {
-        taaShader.reset();
+
+    const std::vector<std::filesystem::path> shaderDirs = ShaderRoots();
+    if (!shaderDirs.empty()) {
+        shaderWatcher = std::make_unique<ShaderWatcher>(shaderDirs);
+        std::fprintf(stderr, "[hot reload] watching %zu shader dir(s)\n", shaderDirs.size());
+        for (const auto& dir : shaderDirs) DebugPrintPath("hot reload", dir.string());
     }
 
+    // Only the programs of the start-up mode are built; the rest are requested when selected.
+    shaderStart = std::chrono::steady_clock::now();
+    shaderStartReported = false;
+    requestedShader = activeShader;
+    requestedQuality = activeQuality;
+    requestMode(activeShader, activeQuality);
+
     quad = CreateQuad();
     triangle = CreateTriangle();
 
-    auto loadTex2D = [&](std::unique_ptr<Texture>& dst, const char* filename) {
+    // Decoding runs on the worker pool; pumpTextureUploads() hands each texture to the
+    // loader thread (or streams it in from this one, a few MB per frame) once decoded.
+    if (!workers) workers = std::make_unique<ThreadPool>();
+    if (!textureStreamer) textureStreamer = std::make_unique<TextureStreamer>();
+    if (!textureRegistry) textureRegistry = std::make_unique<TextureRegistry>(textureBudget);
+
+    // The cloud noise comes either from the compute shaders or from files / CPU generation.
+    if (!gpuNoiseEnabled || !generateGpuNoise()) {
+        gpuNoiseEnabled = false;
+        queueNoiseTextures();
+    }
+
+    queueFileTextures();
+
+    destroySamplers();
+    createSamplers();
+
+    destroyTaaTargets();
+    destroyCloudTargets();
+    destroyCloudHistory();
+    taaHistoryValid = false;
+    frameCounter = 0;
+}
+
+ShaderDefines Init::cloudQualityDefines(CloudQuality quality) {
+    switch (quality) {
+    case CloudQuality::Low:
+        return { { "CLOUD_PRIMARY_STEPS", "32" }, { "CLOUD_LIGHT_SAMPLES", "3" }, { "CLOUD_HF_EROSION", "0" }, { "CLOUD_CURL", "0" } };
+    case CloudQuality::Medium:
+        return { { "CLOUD_PRIMARY_STEPS", "56" }, { "CLOUD_LIGHT_SAMPLES", "5" } };
+    case CloudQuality::Ultra:
+        return { { "CLOUD_PRIMARY_STEPS", "128" }, { "CLOUD_LIGHT_SAMPLES", "12" } };
+    case CloudQuality::High:
+    default:
+        return {};
+    }
+}
+
+const char* Init::cloudQualityName(CloudQuality quality) {
+    switch (quality) {
+    case CloudQuality::Low: return "low";
+    case CloudQuality::Medium: return "medium";
+    case CloudQuality::High: return "high";
+    case CloudQuality::Ultra: return "ultra";
+    default: return "?";
+    }
+}
+
+void Init::setCloudQuality(CloudQuality quality) {
+    requestedQuality = quality;
+}
+
+std::vector<Init::ProgramRequest> Init::modePrograms(int mode, CloudQuality quality) {
+    auto variant = [&](const char* frag) {
+        ShaderDefines defines = cloudQualityDefines(quality);
+        std::unique_ptr<Shader>* slot = &variantSlot(frag, defines);
+        return ProgramRequest{ slot, frag, std::move(defines) };
+        };
+
+    switch (mode) {
+    case 1: return { { &shader, "fragment.glsl", {} } };
+    case 2: return { { &fragmentv2, "fragmentv2.glsl", {} } };
+    case 3: return { variant("RayMarchingFragment.glsl") };
+    case 4: return { variant("RayMarching2.glsl") };
+    case 5: return { variant("singlecloudfrag.glsl") };
+    case 6: return { { &water, "waterfrag.glsl", {} } };
+    case 7: return { { &watersky, "waterskyfrag.glsl", {} } };
+    default: return { { &watersky, "waterskyfrag.glsl", {} }, variant("clouds_over.glsl") };
+    }
+}
+
+std::unique_ptr<Shader>& Init::variantSlot(const char* frag, const ShaderDefines& defines) {
+    return programVariants[std::string(frag) + "|" + Shader::definesKey(defines)];
+}
+
+Shader* Init::requestVertexStage() {
+    if (fullscreenVertex) return fullscreenVertex->isReady() ? fullscreenVertex.get() : nullptr;
+    if (failedShaderFiles.count("vertex.glsl") || programLoads.count(&fullscreenVertex)) return nullptr;
+
+    try {
+        const std::string vs = FindShaderFile("vertex.glsl");
+        DebugPrintPath("shader.vs", vs);
+        startProgramBuild(fullscreenVertex, GL_VERTEX_SHADER, vs, {}, "vertex.glsl");
+        if (!fullscreenVertex) return nullptr;
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Shader load failed (vertex.glsl): %s\n", e.what());
+        failedShaderFiles.insert("vertex.glsl");
+        fullscreenVertex.reset();
+        return nullptr;
+    }
+    return fullscreenVertex->isReady() ? fullscreenVertex.get() : nullptr;
+}
+
+Shader* Init::requestProgram(std::unique_ptr<Shader>& dst, const char* frag, const ShaderDefines& defines) {
+    Shader* vertexStage = requestVertexStage();
+
+    const std::string failKey = std::string(frag) + "|" + Shader::definesKey(defines);
+    if (!dst && !failedShaderFiles.count(failKey) && !programLoads.count(&dst)) {
         try {
-            const std::string p = FindTextureFile(filename);
-            DebugPrintPath("tex2D", p);
-            dst = std::make_unique<Texture>(p.c_str());
-            dst->LoadTextureA();
+            const std::string fs = FindShaderFile(frag);
+            DebugPrintPath("shader.fs", fs);
+            startProgramBuild(dst, GL_FRAGMENT_SHADER, fs, defines, failKey);
+            if (dst && dst->isReady()) onProgramReady(dst);
         }
         catch (const std::exception& e) {
-            std::fprintf(stderr, "Texture init failed (%s): %s\n", filename, e.what());
+            std::fprintf(stderr, "Shader load failed (%s): %s\n", frag, e.what());
+            failedShaderFiles.insert(failKey);
             dst.reset();
         }
-        };
+    }
+
+    if (!dst || !dst->isReady() || !vertexStage) return nullptr;
+
+    // Pair the fragment program with the one shared fullscreen vertex program.
+    if (!dst->hasPipeline() || dst->getPipelineVertexStage() != vertexStage->ID) {
+        dst->setVertexStage(*vertexStage);
+    }
+    return dst.get();
+}
 
-    auto loadTex3D = [&](std::unique_ptr<Texture>& dst, const char* filename) {
+bool Init::requestMode(int mode, CloudQuality quality) {
+    bool ready = true;
+    for (auto& entry : modePrograms(mode, quality)) {
+        if (!requestProgram(*entry.slot, entry.frag, entry.defines)) ready = false;
+    }
+    return ready;
+}
+
+bool Init::modeFailed(int mode, CloudQuality quality) {
+    for (auto& entry : modePrograms(mode, quality)) {
+        const std::unique_ptr<Shader>& s = *entry.slot;
+        const std::string failKey = std::string(entry.frag) + "|" + Shader::definesKey(entry.defines);
+        if ((s && s->hasFailed()) || failedShaderFiles.count(failKey)) return true;
+    }
+    return (fullscreenVertex && fullscreenVertex->hasFailed()) || failedShaderFiles.count("vertex.glsl") != 0;
+}
+
+void Init::onProgramReady(std::unique_ptr<Shader>& slot) {
+    bindingsFor(*slot);
+
+    if (&slot == &fullscreenVertex) return;
+    cloudUniformsFor(*slot);
+
+    if (&slot == &taaShader) {
+        taaUniforms.resolution = taaShader->uniform<glm::vec2>("uResolution");
+        taaUniforms.alpha = taaShader->uniform<float>("uAlpha");
+        taaUniforms.viewProj = taaShader->uniform<glm::mat4>("uViewProj");
+        taaUniforms.prevViewProj = taaShader->uniform<glm::mat4>("uPrevViewProj");
+    }
+}
+
+std::vector<std::unique_ptr<Shader>*> Init::programSlots() {
+    std::vector<std::unique_ptr<Shader>*> slots = {
+        &fullscreenVertex, &shader, &fragmentv2, &water, &watersky, &taaShader, &cloudUpsampleShader,
+        &cloudReprojectShader, &cloudCompositeShader
+    };
+    for (auto& variant : programVariants) {
+        slots.push_back(&variant.second);
+    }
+    return slots;
+}
+
+void Init::startProgramBuild(std::unique_ptr<Shader>& slot, GLenum stage, const std::string& path,
+    const ShaderDefines& defines, const std::string& failKey, bool reload) {
+    if (!loader) {
+        std::unique_ptr<Shader>& dst = reload ? shaderReloads[&slot] : slot;
+        dst = std::make_unique<Shader>(stage, path.c_str(), defines, Shader::BuildMode::Deferred);
+        return;
+    }
+    // The loader only submits compile + link, so several programs build in the driver at
+    // once; pumpShaderBuilds / pumpShaderReloads poll them here. Without parallel compile
+    // poll() would block, so the link is finished over there instead.
+    programLoads[&slot] = { loader->submit([stage, path, defines] {
+        auto program = std::make_unique<Shader>(stage, path.c_str(), defines, Shader::BuildMode::Deferred);
+        if (!Shader::hasParallelCompile()) program->poll();
+        return program;
+        }), failKey, reload };
+}
+
+void Init::pumpProgramLoads() {
+    for (auto it = programLoads.begin(); it != programLoads.end();) {
+        ProgramLoad& load = it->second;
+        if (load.shader.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        std::unique_ptr<Shader>& slot = *it->first;
         try {
-            const std::string p = FindTextureFile(filename);
-            DebugPrintPath("tex3D", p);
-            dst = std::make_unique<Texture>(p.c_str());
-            dst->LoadTexture3D();
+            std::unique_ptr<Shader> program = load.shader.get();
+            if (load.reload) shaderReloads[&slot] = std::move(program);
+            else {
+                slot = std::move(program);
+                if (slot->isReady()) onProgramReady(slot);
+            }
         }
         catch (const std::exception& e) {
-            std::fprintf(stderr, "Texture3D init failed (%s): %s\n", filename, e.what());
-            dst.reset();
+            std::fprintf(stderr, "Shader load failed (%s): %s\n", load.failKey.c_str(), e.what());
+            if (!load.reload) failedShaderFiles.insert(load.failKey);
+        }
+        it = programLoads.erase(it);
+    }
+}
+
+void Init::pumpShaderBuilds() {
+    pumpProgramLoads();
+    pumpShaderReloads();
+
+    bool compiling = !programLoads.empty();
+    for (std::unique_ptr<Shader>* slot : programSlots()) {
+        Shader* s = slot->get();
+        if (!s || s->getBuildState() != Shader::BuildState::Compiling) continue;
+
+        if (!s->poll()) {
+            compiling = true;
+            continue;
         }
+        if (s->isReady()) onProgramReady(*slot);
+    }
+
+    if (!shaderStartReported && !compiling) {
+        shaderStartReported = true;
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count();
+        const int hits = programCache->getHits();
+        const int misses = programCache->getMisses();
+        const char* kind = !programCache->isEnabled() ? "uncached" : (misses == 0 ? "warm" : (hits == 0 ? "cold" : "partial"));
+        std::fprintf(stderr, "[shaders] %s start: %.1f ms (%d from binary cache, %d compiled, %d rejected)\n",
+            kind, ms, hits, misses, programCache->getRejected());
+    }
+}
+
+void Init::startShaderReload(std::unique_ptr<Shader>& slot) {
+    const std::string rel = ShaderRelativePath(slot->getSourceFiles().front(), shaderWatcher->getRoots());
+    if (rel.empty()) return;
+
+    try {
+        const std::string path = FindShaderFile(rel.c_str());
+        const GLenum stage = &slot == &fullscreenVertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
+        startProgramBuild(slot, stage, path, slot->getDefines(), rel, true);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "[hot reload] %s failed, keeping the previous program: %s\n", rel.c_str(), e.what());
+        shaderReloads.erase(&slot);
+    }
+}
+
+void Init::pumpShaderReloads() {
+    if (!shaderWatcher) return;
+
+    const std::vector<ShaderWatcher::Change> changes = shaderWatcher->takeChanges();
+    if (!changes.empty()) {
+        // Resolve shaders from the directory being edited from now on, so edits in the
+        // source tree win over the copy next to the executable.
+        if (PreferredShaderRoot() != changes.back().root) {
+            PreferredShaderRoot() = changes.back().root;
+            DebugPrintPath("hot reload", "loading shaders from " + changes.back().root.string());
+        }
+        failedShaderFiles.clear();
+
+        for (std::unique_ptr<Shader>* slot : programSlots()) {
+            if (!*slot || (*slot)->getSourceFiles().empty()) continue;
+
+            bool affected = false;
+            for (const std::string& file : (*slot)->getSourceFiles()) {
+                const std::string rel = ShaderRelativePath(file, shaderWatcher->getRoots());
+                for (const auto& change : changes) {
+                    if (rel == change.relativePath) affected = true;
+                }
+            }
+            if (affected) startShaderReload(*slot);
+        }
+    }
+
+    for (auto it = shaderReloads.begin(); it != shaderReloads.end();) {
+        Shader& next = *it->second;
+        if (next.getBuildState() == Shader::BuildState::Compiling && !next.poll()) {
+            ++it;
+            continue;
+        }
+
+        std::unique_ptr<Shader>& slot = *it->first;
+        const std::string name = ShaderRelativePath(next.getSourceFiles().front(), shaderWatcher->getRoots());
+        if (next.isReady()) {
+            if (slot) {
+                programBindings.erase(slot->ID);
+                cloudUniforms.erase(slot->ID);
+            }
+            slot = std::move(it->second);
+            onProgramReady(slot);
+            std::fprintf(stderr, "[hot reload] %s reloaded\n", name.c_str());
+        }
+        else {
+            std::fprintf(stderr, "[hot reload] %s failed, keeping the previous program:\n%s\n", name.c_str(), next.getBuildError().c_str());
+        }
+        it = shaderReloads.erase(it);
+    }
+}
+
+// Volumes passed a `generate` fallback are built procedurally when no file is shipped.
+void Init::queueTexture(std::shared_ptr<Texture>& dst, TextureUnit unit, const char* filename, const TextureImport& import,
+    const NoiseGenerator::Settings* generate) {
+    const bool volume = import.volume;
+    // A newer request for the unit replaces one still in flight. Units waiting on that load
+    // (same key) take it over instead of losing their texture with it.
+    for (PendingTexture& replaced : pendingTextures) {
+        if (replaced.unit != unit || !replaced.inFlight()) continue;
+        auto follower = std::find_if(pendingTextures.begin(), pendingTextures.end(), [&replaced](const PendingTexture& t) {
+            return t.unit != replaced.unit && t.key == replaced.key && !t.inFlight();
+            });
+        if (follower == pendingTextures.end()) continue;
+        follower->decode = std::move(replaced.decode);
+        follower->stream = std::move(replaced.stream);
+        follower->load = std::move(replaced.load);
+    }
+    pendingTextures.erase(std::remove_if(pendingTextures.begin(), pendingTextures.end(), [unit](const PendingTexture& t) {
+        return t.unit == unit;
+        }), pendingTextures.end());
+
+    std::string p;
+    std::string missing;
+    std::function<TextureData()> decode;
+    try {
+        p = FindTextureFile(filename);
+        DebugPrintPath(volume ? "tex3D" : "tex2D", p);
+        decode = [p, import] { return Texture::Decode(p, import); };
+    }
+    catch (const std::exception& e) {
+        missing = e.what();
+        if (generate) {
+            const NoiseGenerator::Settings settings = *generate;
+            p = std::string("generated:") + NoiseGenerator::VolumeName(settings.volume) + ":" +
+                std::to_string(settings.size) + ":" + std::to_string(settings.seed);
+            decode = [settings, name = std::string(filename)] {
+                std::fprintf(stderr, "[textures] %s not found, generating %s noise (%u^3)\n", name.c_str(),
+                    NoiseGenerator::VolumeName(settings.volume), settings.size);
+                return Texture::GenerateNoise(settings);
+            };
+        }
+    }
+
+    // A baked .vol next to the source wins: raw or block-compressed, with its mips
+    // (see tools/vol_convert, tools/bc_compress). A bad one falls back to the source.
+    try {
+        const std::string baked = std::filesystem::path(filename).replace_extension(".vol").string();
+        const std::string vol = FindTextureFile(baked.c_str());
+        DebugPrintPath("vol", vol);
+        decode = [vol, source = std::move(decode)] {
+            TextureData data = Texture::DecodeVolume(vol);
+            if (!data && source) {
+                std::fprintf(stderr, "[textures] %s: %s, using the source instead\n", vol.c_str(), data.error.c_str());
+                return source();
+            }
+            return data;
         };
+        p = vol;
+    }
+    catch (const std::exception&) {
+    }
+    if (!decode) {
+        std::fprintf(stderr, "Texture%s init failed (%s): %s\n", volume ? "3D" : "", filename, missing.c_str());
+        dst.reset();
+        return;
+    }
+
+    const std::string key = TextureRegistry::MakeKey(p, import);
+    if (TextureRegistry::Handle cached = textureRegistry->find(key)) {
+        std::fprintf(stderr, "[textures] %s: cached\n", filename);
+        unitTextures[unit] = cached->GetID();
+        dst = std::move(cached);
+        return;
+    }
+
+    if (pendingTextures.empty()) {
+        textureStart = std::chrono::steady_clock::now();
+        textureDecodeMs = 0.0;
+        textureUploadMs = 0.0;
+    }
+    // Another unit already loading the same texture: wait for its registry entry instead.
+    const bool inFlight = std::any_of(pendingTextures.begin(), pendingTextures.end(), [&key](const PendingTexture& t) {
+        return t.key == key && t.inFlight();
+        });
+    pendingTextures.push_back({ &dst, unit, filename, import, key, inFlight ? std::future<TextureData>() : workers->submit(decode) });
+}
 
-    loadTex3D(lowfreq3D, "LowFrequency3DTexture.tga");
-    loadTex3D(highfreq3D, "HighFrequency3DTexture.tga");
+TextureImport Init::unitImport(TextureUnit unit) {
+    TextureImport import;
+    switch (unit) {
+    case kUnitLowFrequency:
+    case kUnitHighFrequency:
+        // Trilinear across the mip chain.
+        return TextureImport::Volume();
+    case kUnitWeather:
+        // Coverage only reads red, but from the 16-bit source: 8 bits band at the coverage threshold.
+        import = TextureImport::Data(1, 16);
+        import.mips = false;
+        return import;
+    case kUnitCurl:
+        import = TextureImport::Data(2);
+        import.mips = false;
+        return import;
+    case kUnitGradientStratus:
+    case kUnitGradientCumulus:
+    case kUnitGradientCumulonimbus:
+        // 1x300 grayscale height profiles; must not wrap the cloud top into its base.
+        import = TextureImport::Gray();
+        import.mips = false;
+        import.wrap = GL_CLAMP_TO_EDGE;
+        return import;
+    default:
+        return import;
+    }
+}
 
-    loadTex2D(weathermap2D, "weathermap.png");
-    loadTex2D(curlnoise2D, "curlNoise.png");
+void Init::queueFileTextures() {
+    queueTexture(weathermap2D, kUnitWeather, weatherMapFile.c_str(), unitImport(kUnitWeather));
+    queueTexture(gradient_stratus, kUnitGradientStratus, "gradient_stratus.png", unitImport(kUnitGradientStratus));
+    queueTexture(gradient_cumulus, kUnitGradientCumulus, "gradient_cumulus.png", unitImport(kUnitGradientCumulus));
+    queueTexture(gradient_cumulonimbus, kUnitGradientCumulonimbus, "gradient_cumulonimbus.png", unitImport(kUnitGradientCumulonimbus));
+}
 
-    loadTex2D(gradient_stratus, "gradient_stratus.png");
-    loadTex2D(gradient_cumulus, "gradient_cumulus.png");
-    loadTex2D(gradient_cumulonimbus, "gradient_cumulonimbus.png");
+void Init::reloadTextures() {
+    if (!workers) return;
+    std::fprintf(stderr, "[textures] reloading\n");
+    // Forget the cached entries so the files are read again; bound textures live on until replaced.
+    textureRegistry->clear();
+    if (!gpuNoiseEnabled) queueNoiseTextures();
+    queueFileTextures();
+}
 
-    destroyTaaTargets();
-    taaHistoryValid = false;
-    frameCounter = 0;
+void Init::queueNoiseTextures() {
+    NoiseGenerator::Settings lowFrequencyNoise;
+    lowFrequencyNoise.volume = NoiseGenerator::Volume::LowFrequency;
+    lowFrequencyNoise.size = noiseResolution.lowFrequency;
+    lowFrequencyNoise.seed = noiseSeed;
+    NoiseGenerator::Settings highFrequencyNoise;
+    highFrequencyNoise.volume = NoiseGenerator::Volume::HighFrequency;
+    highFrequencyNoise.size = noiseResolution.highFrequency;
+    highFrequencyNoise.seed = noiseSeed;
+
+    queueTexture(lowfreq3D, kUnitLowFrequency, "LowFrequency3DTexture.tga", unitImport(kUnitLowFrequency), &lowFrequencyNoise);
+    queueTexture(highfreq3D, kUnitHighFrequency, "HighFrequency3DTexture.tga", unitImport(kUnitHighFrequency), &highFrequencyNoise);
+    queueTexture(curlnoise2D, kUnitCurl, "curlNoise.png", unitImport(kUnitCurl));
+}
+
+bool Init::generateGpuNoise() {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Texture> low, high, curl;
+    NoiseGenerator::Settings lowSettings;
+    lowSettings.volume = NoiseGenerator::Volume::LowFrequency;
+    lowSettings.size = noiseResolution.lowFrequency;
+    lowSettings.seed = noiseSeed;
+    NoiseGenerator::Settings highSettings;
+    highSettings.volume = NoiseGenerator::Volume::HighFrequency;
+    highSettings.size = noiseResolution.highFrequency;
+    highSettings.seed = noiseSeed;
+
+    try {
+        if (!gpuNoise) gpuNoise = std::make_unique<GpuNoise>(FindShaderFile("noise_volume.comp"), FindShaderFile("noise_curl.comp"));
+        low = gpuNoise->generateVolume(lowSettings);
+        high = gpuNoise->generateVolume(highSettings);
+        curl = gpuNoise->generateCurl(noiseResolution.curl, noiseSeed);
+        if (!low || !high || !curl) throw std::runtime_error("noise resolutions must be powers of two >= 4");
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "[noise] GPU noise unavailable, using texture files: %s\n", e.what());
+        gpuNoise.reset();
+        return false;
+    }
+
+    // Pending file loads for these units would overwrite the generated textures.
+    pendingTextures.erase(std::remove_if(pendingTextures.begin(), pendingTextures.end(), [](const PendingTexture& t) {
+        return t.unit == kUnitLowFrequency || t.unit == kUnitHighFrequency || t.unit == kUnitCurl;
+        }), pendingTextures.end());
+
+    if (verifyGpuNoise) {
+        const uint32_t curlSize = noiseResolution.curl, seed = noiseSeed;
+        const size_t lowBytes = (size_t)lowSettings.size * lowSettings.size * lowSettings.size * 4;
+        const size_t highBytes = (size_t)highSettings.size * highSettings.size * highSettings.size * 4;
+        noiseChecks.push_back({ "low-frequency", GpuNoise::readBack(*low, lowBytes),
+            workers->submit([lowSettings] { return NoiseGenerator::Generate(lowSettings); }) });
+        noiseChecks.push_back({ "high-frequency", GpuNoise::readBack(*high, highBytes),
+            workers->submit([highSettings] { return NoiseGenerator::Generate(highSettings); }) });
+        noiseChecks.push_back({ "curl", GpuNoise::readBack(*curl, (size_t)curlSize * curlSize * 4),
+            workers->submit([curlSize, seed] { return NoiseGenerator::GenerateCurl(curlSize, seed); }) });
+    }
+
+    glFinish();
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "[noise] GPU noise: low %u^3, high %u^3, curl %u^2 in %.1f ms\n",
+        lowSettings.size, highSettings.size, noiseResolution.curl, ms);
+
+    unitTextures[kUnitLowFrequency] = low->GetID();
+    unitTextures[kUnitHighFrequency] = high->GetID();
+    unitTextures[kUnitCurl] = curl->GetID();
+    lowfreq3D = std::move(low);
+    highfreq3D = std::move(high);
+    curlnoise2D = std::move(curl);
+    return true;
+}
+
+void Init::pumpNoiseChecks() {
+    for (auto it = noiseChecks.begin(); it != noiseChecks.end();) {
+        if (it->cpu.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        const GpuNoise::Comparison c = GpuNoise::compare(it->gpu, it->cpu.get());
+        std::fprintf(stderr, "[noise] %s: gpu %016llx, cpu %016llx, %zu byte(s) differ, max diff %d -> %s\n",
+            it->name, (unsigned long long)c.gpuChecksum, (unsigned long long)c.cpuChecksum, c.differingBytes, c.maxDifference,
+            c.gpuChecksum == c.cpuChecksum ? "identical" : (c.matches() ? "within tolerance" : "MISMATCH"));
+        it = noiseChecks.erase(it);
+    }
+}
+
+void Init::setGpuNoise(bool enabled) {
+    if (enabled == gpuNoiseEnabled) return;
+    gpuNoiseEnabled = enabled;
+    if (!workers) return; // initialize() picks the source
+
+    if (enabled && !generateGpuNoise()) gpuNoiseEnabled = false;
+    if (!gpuNoiseEnabled) queueNoiseTextures();
+}
+
+void Init::setWeatherMap(const std::string& file) {
+    weatherMapFile = file;
+    if (workers) queueTexture(weathermap2D, kUnitWeather, weatherMapFile.c_str(), unitImport(kUnitWeather));
+}
+
+void Init::setCloudDownsample(int factor) {
+    cloudDownsample = factor >= 4 ? 4 : factor >= 2 ? 2 : 1;
+}
+
+void Init::setCloudInterleave(bool enabled) {
+    cloudInterleave = enabled;
+    cloudHistoryValid = false;
+}
+
+void Init::setFrameBudget(double ms) {
+    frameBudgetMs = ms;
+    if (governor && ms > 0.0) governor->setBudget(ms);
+}
+
+void Init::setTextureBudget(size_t bytes) {
+    textureBudget = bytes;
+    if (textureRegistry) textureRegistry->setBudget(bytes);
+}
+
+void Init::setNoiseResolution(const GpuNoise::Resolution& resolution) {
+    noiseResolution = resolution;
+    if (gpuNoiseEnabled && workers && !generateGpuNoise()) {
+        gpuNoiseEnabled = false;
+        queueNoiseTextures();
+    }
+}
+
+void Init::publishTexture(PendingTexture& pending, std::unique_ptr<Texture> texture, size_t bytes) {
+    unitTextures[pending.unit] = texture->GetID();
+    *pending.dst = textureRegistry->insert(pending.key, std::move(texture), bytes);
+}
+
+void Init::pumpTextureUploads() {
+    if (pendingTextures.empty()) return;
+
+    textureStreamer->beginFrame();
+    for (auto it = pendingTextures.begin(); it != pendingTextures.end();) {
+        if (!it->inFlight()) {
+            // Shares the texture another unit is loading.
+            if (TextureRegistry::Handle shared = textureRegistry->find(it->key)) {
+                std::fprintf(stderr, "[textures] %s: shared\n", it->file.c_str());
+                unitTextures[it->unit] = shared->GetID();
+                *it->dst = std::move(shared);
+                it = pendingTextures.erase(it);
+                continue;
+            }
+            const std::string& key = it->key;
+            const bool leaderPending = std::any_of(pendingTextures.begin(), pendingTextures.end(), [&key](const PendingTexture& t) {
+                return t.key == key && t.inFlight();
+                });
+            if (leaderPending) ++it;
+            else it = pendingTextures.erase(it); // the load it waited for failed (and was reported)
+            continue;
+        }
+
+        // Uploaded on the loader thread and already fenced there: ready to bind.
+        if (it->load.valid()) {
+            if (it->load.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            LoadedTexture loaded = it->load.get();
+            if (loaded.texture) {
+                std::fprintf(stderr, "[textures] %s: upload %.1f ms (loader thread)\n", it->file.c_str(), loaded.uploadMs);
+                textureUploadMs += loaded.uploadMs;
+                publishTexture(*it, std::move(loaded.texture), loaded.bytes);
+            }
+            else {
+                std::fprintf(stderr, "Texture%s init failed (%s): %s\n", it->import.volume ? "3D" : "", it->file.c_str(), loaded.error.c_str());
+            }
+            it = pendingTextures.erase(it);
+            continue;
+        }
+
+        const auto uploadStart = std::chrono::steady_clock::now();
+        if (!it->stream) {
+            if (it->decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+
+            TextureData data = it->decode.get();
+            textureDecodeMs += data.decodeMs;
+            std::fprintf(stderr, "[textures] %s: decode %.1f ms (worker)\n", it->file.c_str(), data.decodeMs);
+            if (loader) {
+                auto source = std::make_shared<TextureData>(std::move(data));
+                const TextureImport import = it->import;
+                it->load = loader->submit([source, import] {
+                    const auto start = std::chrono::steady_clock::now();
+                    LoadedTexture loaded;
+                    loaded.texture = std::make_unique<Texture>(source->path.c_str());
+                    if (!*source || !loaded.texture->Upload(*source, import, &loaded.bytes)) {
+                        loaded.error = source->error.empty() ? "unexpected layout" : source->error;
+                        loaded.texture.reset();
+                    }
+                    loaded.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    return loaded;
+                    });
+                ++it;
+                continue;
+            }
+
+            auto stream = std::make_unique<TextureStream>();
+            stream->data = std::move(data);
+            stream->texture = std::make_unique<Texture>(stream->data.path.c_str());
+            if (!stream->texture->BeginUpload(stream->data, it->import, stream->upload, textureStreamer->getMaxRegionBytes())) {
+                std::fprintf(stderr, "Texture%s init failed (%s): %s\n", it->import.volume ? "3D" : "", it->file.c_str(),
+                    stream->data.error.empty() ? "unexpected layout" : stream->data.error.c_str());
+                it = pendingTextures.erase(it);
+                continue;
+            }
+            it->stream = std::move(stream);
+        }
+
+        TextureStream& stream = *it->stream;
+        const bool done = textureStreamer->stream(stream);
+        if (done) stream.texture->FinishUpload(stream.upload);
+        const double uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+        textureUploadMs += uploadMs;
+        if (!done) {
+            ++it;
+            continue;
+        }
+
+        std::fprintf(stderr, "[textures] %s: upload over %d frame(s)\n", it->file.c_str(), stream.frames);
+        publishTexture(*it, std::move(stream.texture), stream.upload.gpuBytes());
+        it = pendingTextures.erase(it);
+    }
+    textureStreamer->endFrame();
+
+    if (pendingTextures.empty()) {
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStart).count();
+        std::fprintf(stderr, "[textures] ready after %.1f ms (decode %.1f ms on %u workers, upload %.1f ms, %s)\n",
+            ms, textureDecodeMs, workers->size(), textureUploadMs,
+            loader ? "loader thread" : textureStreamer->isPersistent() ? "PBO ring" : "client memory");
+        std::fprintf(stderr, "[textures] %zu cached, %.1f / %.1f MB\n", textureRegistry->getEntryCount(),
+            textureRegistry->getUsedBytes() / 1048576.0, textureRegistry->getBudget() / 1048576.0);
+    }
 }
 
 void Init::processInput(GLFWwindow* window) {
@@ -407,14 +1090,37 @@ void Init::processInput(GLFWwindow* window) {
         }
         };
 
-    edgeKey(GLFW_KEY_1, [&] { activeShader = 1; });
-    edgeKey(GLFW_KEY_2, [&] { activeShader = 2; });
-    edgeKey(GLFW_KEY_3, [&] { activeShader = 3; });
-    edgeKey(GLFW_KEY_4, [&] { activeShader = 4; });
-    edgeKey(GLFW_KEY_5, [&] { activeShader = 5; });
-    edgeKey(GLFW_KEY_6, [&] { activeShader = 6; });
-    edgeKey(GLFW_KEY_7, [&] { activeShader = 7; });
-    edgeKey(GLFW_KEY_8, [&] { activeShader = 8; });
+    edgeKey(GLFW_KEY_1, [&] { requestedShader = 1; });
+    edgeKey(GLFW_KEY_2, [&] { requestedShader = 2; });
+    edgeKey(GLFW_KEY_3, [&] { requestedShader = 3; });
+    edgeKey(GLFW_KEY_4, [&] { requestedShader = 4; });
+    edgeKey(GLFW_KEY_5, [&] { requestedShader = 5; });
+    edgeKey(GLFW_KEY_6, [&] { requestedShader = 6; });
+    edgeKey(GLFW_KEY_7, [&] { requestedShader = 7; });
+    edgeKey(GLFW_KEY_8, [&] { requestedShader = 8; });
+
+    edgeKey(GLFW_KEY_F1, [&] { setCloudQuality(CloudQuality::Low); });
+    edgeKey(GLFW_KEY_F2, [&] { setCloudQuality(CloudQuality::Medium); });
+    edgeKey(GLFW_KEY_F3, [&] { setCloudQuality(CloudQuality::High); });
+    edgeKey(GLFW_KEY_F4, [&] { setCloudQuality(CloudQuality::Ultra); });
+
+    edgeKey(GLFW_KEY_G, [&] {
+        const GLState::Counters& c = GLState::get().getLastFrame();
+        std::fprintf(stderr, "[gl state] last frame: %u calls issued, %u elided\n", c.issued, c.elided);
+        if (governor) governor->printLastFrame();
+        });
+
+    edgeKey(GLFW_KEY_P, [&] {
+        if (!profiler) return;
+        profiler->printStats();
+        profiler->writeTrace("profile_trace.json");
+        });
+
+    edgeKey(GLFW_KEY_R, [&] {
+        if (!governor) return;
+        governor->setEnabled(!governor->isEnabled());
+        std::fprintf(stderr, "[resolution] dynamic resolution: %s\n", governor->isEnabled() ? "on" : "off");
+        });
 
     edgeKey(GLFW_KEY_T, [&] {
         taaEnabled = !taaEnabled;
@@ -432,6 +1138,36 @@ void Init::processInput(GLFWwindow* window) {
         taaHistoryValid = false;
         });
 
+    edgeKey(GLFW_KEY_C, [&] {
+        setCloudDownsample(cloudDownsample == 4 ? 1 : cloudDownsample * 2);
+        std::fprintf(stderr, "[clouds] resolution 1/%d\n", cloudDownsample);
+        });
+
+    edgeKey(GLFW_KEY_I, [&] {
+        setCloudInterleave(!cloudInterleave);
+        std::fprintf(stderr, "[clouds] 4x4 interleaved: %s\n", cloudInterleave ? "on" : "off");
+        });
+
+    edgeKey(GLFW_KEY_N, [&] { setGpuNoise(!gpuNoiseEnabled); });
+    edgeKey(GLFW_KEY_F5, [&] { reloadTextures(); });
+    edgeKey(GLFW_KEY_M, [&] {
+        static const char* const kWeatherMaps[] = { "weathermap.png", "weather_v4.tga", "weather_model.tga", "weather_model2.tga" };
+        const auto current = std::find(std::begin(kWeatherMaps), std::end(kWeatherMaps), weatherMapFile);
+        const size_t next = current == std::end(kWeatherMaps) ? 0 : (current - std::begin(kWeatherMaps) + 1) % std::size(kWeatherMaps);
+        setWeatherMap(kWeatherMaps[next]);
+        });
+
+    // halve / double the generated noise resolution (GPU noise only)
+    auto scaleNoise = [&](bool up) {
+        GpuNoise::Resolution r = noiseResolution;
+        r.lowFrequency = std::clamp(up ? r.lowFrequency * 2 : r.lowFrequency / 2, 32u, 256u);
+        r.highFrequency = std::clamp(r.lowFrequency / 4, 8u, 64u);
+        r.curl = r.lowFrequency;
+        setNoiseResolution(r);
+        };
+    edgeKey(GLFW_KEY_COMMA, [&] { scaleNoise(false); });
+    edgeKey(GLFW_KEY_PERIOD, [&] { scaleNoise(true); });
+
     edgeKey(GLFW_KEY_KP_ADD, [&] {
         cloudBottom += 200.0f;
         cloudTop += 200.0f;
@@ -443,124 +1179,209 @@ void Init::processInput(GLFWwindow* window) {
         });
 }
 
-void Init::bindCommonUniforms(Shader& s, int w, int h, float t, bool taaEnabledPass) {
-    glUseProgram(s.ID);
+const Init::CloudUniforms& Init::cloudUniformsFor(const Shader& s) {
+    auto it = cloudUniforms.find(s.ID);
+    if (it != cloudUniforms.end()) return it->second;
 
-    Set1fAny(s.ID, t, { "Time", "time", "uTime", "iTime" });
+    CloudUniforms u;
+    u.pixelScale = s.uniform<float>("uPixelScale");
+    u.pixelOffset = s.uniform<glm::vec2>("uPixelOffset");
+    u.historyValid = s.uniform<bool>("uHistoryValid");
+    return cloudUniforms.emplace(s.ID, u).first->second;
+}
 
-    Set1fAny(s.ID, (float)w, { "screenWidth", "ScreenWidth" });
-    Set1fAny(s.ID, (float)h, { "screenHeight","ScreenHeight" });
-    Set2fAny(s.ID, (float)w, (float)h, { "resolution", "uResolution", "iResolution", "Resolution" });
+const Init::ProgramBindings& Init::bindingsFor(const Shader& s) {
+    auto it = programBindings.find(s.ID);
+    if (it != programBindings.end()) return it->second;
+
+    const std::pair<GLuint, std::initializer_list<std::string_view>> samplers[] = {
+        { kUnitLowFrequency, { "lowFrequencyTexture", "cloudBaseShapeSampler", "cloudBaseShapeTexture", "LowFrequencyTexture" } },
+        { kUnitHighFrequency, { "highFrequencyTexture", "cloudHighFreqSampler", "cloudHighFreqTexture", "HighFrequencyTexture" } },
+        { kUnitWeather, { "WeatherTexture", "weatherMapSampler", "weatherTexture", "WeatherMap" } },
+        { kUnitCurl, { "CurlNoiseTexture", "curlNoiseSampler", "curlNoiseTexture", "CurlNoise" } },
+        { kUnitGradientStratus, { "GradientStratusTexture", "gradientStratusSampler", "gradientStratusTexture" } },
+        { kUnitGradientCumulus, { "GradientCumulusTexture", "gradientCumulusSampler", "gradientCumulusTexture" } },
+        { kUnitGradientCumulonimbus, { "GradientCumulonimbusTexture", "gradientCumulonimbusSampler", "gradientCumulonimbusTexture" } },
+        { kUnitTaaCurrent, { "uCurrent" } },
+        { kUnitTaaHistory, { "uHistory" } },
+        { kUnitTaaDepth, { "uSceneDepth" } },
+        { kUnitCloudLowRes, { "uCloudLowRes" } },
+        { kUnitCloudDepth, { "uCloudDepth" } },
+        { kUnitCloudHistory, { "uCloudHistory" } },
+    };
 
-    Set3fAny(s.ID, camera->Position, { "cameraPosition", "camPos", "uCamPos" });
-    Set3fAny(s.ID, camera->Front, { "cameraFront", "camFront", "uCamFront" });
-    Set3fAny(s.ID, camera->Up, { "cameraUp", "camUp", "uCamUp" });
-    Set3fAny(s.ID, camera->Right, { "cameraRight", "camRight", "uCamRight" });
+    GLuint first = kUnitCount;
+    GLuint last = 0;
+    for (const auto& sampler : samplers) {
+        const GLint location = s.getUniformLocationAny(sampler.second);
+        if (location == -1) continue;
 
-    glm::vec3 earthCenter(camera->Position.x, -kEarthRadius, camera->Position.z);
-    Set3fAny(s.ID, earthCenter, { "EarthCenter", "earthCenter", "uEarthCenter" });
+        glProgramUniform1i(s.ID, location, (GLint)sampler.first);
+        first = std::min(first, sampler.first);
+        last = std::max(last, sampler.first);
+    }
 
-    Set1fAny(s.ID, cloudBottom, { "CloudBottom", "uCloudBottom" });
-    Set1fAny(s.ID, cloudTop, { "CloudTop", "uCloudTop" });
+    ProgramBindings b;
+    if (first <= last) {
+        b.firstUnit = first;
+        b.count = (GLsizei)(last - first + 1);
+    }
+    return programBindings.emplace(s.ID, b).first->second;
+}
 
-    glm::vec2 jitter(0.0f, 0.0f);
-    if (taaEnabledPass) {
-        jitter = Halton2D((int)frameCounter);
+void Init::createSamplers() {
+    // File-backed units follow their import (mips -> trilinear, wrap); the render
+    // targets from kUnitTaaCurrent on clamp.
+    GLuint repeatLinear = 0;
+    GLuint repeatMipmapped = 0;
+    GLuint clampLinear = 0;
+    glCreateSamplers(1, &repeatLinear);
+    glCreateSamplers(1, &repeatMipmapped);
+    glCreateSamplers(1, &clampLinear);
+
+    glSamplerParameteri(repeatLinear, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(repeatLinear, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(repeatLinear, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(repeatLinear, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glSamplerParameteri(repeatLinear, GL_TEXTURE_WRAP_R, GL_REPEAT);
+
+    glSamplerParameteri(repeatMipmapped, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(repeatMipmapped, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(repeatMipmapped, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(repeatMipmapped, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glSamplerParameteri(repeatMipmapped, GL_TEXTURE_WRAP_R, GL_REPEAT);
+
+    glSamplerParameteri(clampLinear, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(clampLinear, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(clampLinear, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(clampLinear, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    for (GLuint unit = 0; unit < kUnitCount; ++unit) {
+        if (unit >= kUnitTaaCurrent) {
+            unitSamplers[unit] = clampLinear;
+            continue;
+        }
+        const TextureImport import = unitImport((TextureUnit)unit);
+        unitSamplers[unit] = import.mips ? repeatMipmapped : import.wrap == GL_CLAMP_TO_EDGE ? clampLinear : repeatLinear;
     }
-    Set2fAny(s.ID, jitter.x, jitter.y, { "HaltonSequence", "uJitter", "uHalton", "halton" });
+    GLState::get().bindSamplers(0, kUnitCount, unitSamplers);
+}
 
-    glm::mat4 I(1.0f);
-    SetMat4Any(s.ID, I, { "model", "Model" });
-    SetMat4Any(s.ID, I, { "view", "View" });
-    SetMat4Any(s.ID, I, { "projection", "Projection" });
+void Init::destroySamplers() {
+    const GLuint objects[] = { unitSamplers[kUnitLowFrequency], unitSamplers[kUnitWeather], unitSamplers[kUnitTaaCurrent] };
+    for (GLuint sampler : objects) {
+        if (!sampler) continue;
+        glDeleteSamplers(1, &sampler);
+        GLState::get().samplerDeleted(sampler);
+    }
+    for (GLuint& sampler : unitSamplers) sampler = 0;
 }
 
-void Init::bindTextures(Shader& s) {
-    glUseProgram(s.ID);
+void Init::uploadFrameData(int w, int h, float t, bool taaEnabledPass) {
+    if (!frameUniforms) return;
 
-    int unit = 0;
+    FrameData fd{};
+    fd.time = t;
+    fd.screenWidth = (float)w;
+    fd.screenHeight = (float)h;
+    fd.resolution = glm::vec2((float)w, (float)h);
 
-    if (lowfreq3D) {
-        Bind3D(*lowfreq3D, s,
-            { "lowFrequencyTexture", "cloudBaseShapeSampler", "cloudBaseShapeTexture", "LowFrequencyTexture" },
-            unit++);
-    }
+    fd.cameraPosition = camera->Position;
+    fd.cameraFront = camera->Front;
+    fd.cameraUp = camera->Up;
+    fd.cameraRight = camera->Right;
 
-    if (highfreq3D) {
-        Bind3D(*highfreq3D, s,
-            { "highFrequencyTexture", "cloudHighFreqSampler", "cloudHighFreqTexture", "HighFrequencyTexture" },
-            unit++);
-    }
+    fd.earthCenter = glm::vec3(camera->Position.x, -kEarthRadius, camera->Position.z);
+    fd.cloudBottom = cloudBottom;
+    fd.cloudTop = cloudTop;
 
-    if (weathermap2D) {
-        Bind2D(*weathermap2D, s,
-            { "WeatherTexture", "weatherMapSampler", "weatherTexture", "WeatherMap" },
-            unit++);
+    fd.jitter = glm::vec2(0.0f, 0.0f);
+    if (taaEnabledPass) {
+        fd.jitter = Halton2D((int)frameCounter);
     }
 
-    if (curlnoise2D) {
-        Bind2D(*curlnoise2D, s,
-            { "CurlNoiseTexture", "curlNoiseSampler", "curlNoiseTexture", "CurlNoise" },
-            unit++);
-    }
+    const CameraFrame current{ camera->Position, camera->Front, camera->Up, camera->Right };
+    previousCamera = hasPreviousCamera ? currentCamera : current;
+    currentCamera = current;
+    hasPreviousCamera = true;
+    fd.prevCameraPosition = previousCamera.position;
+    fd.prevCameraFront = previousCamera.front;
+    fd.prevCameraUp = previousCamera.up;
+    fd.prevCameraRight = previousCamera.right;
 
-    if (gradient_stratus) {
-        Bind2D(*gradient_stratus, s,
-            { "GradientStratusTexture", "gradientStratusSampler", "gradientStratusTexture" },
-            unit++);
-    }
+    frameUniforms->update(fd);
+}
 
-    if (gradient_cumulus) {
-        Bind2D(*gradient_cumulus, s,
-            { "GradientCumulusTexture", "gradientCumulusSampler", "gradientCumulusTexture" },
-            unit++);
-    }
+glm::mat4 Init::viewProjection(const CameraFrame& c, float aspect) {
+    // Rays leave at front * F + right * ndc.x * aspect + up * ndc.y, i.e. tan(fovy / 2) = 1 / F.
+    const glm::mat4 proj = glm::perspective(2.0f * std::atan(1.0f / kCameraFocalLength), aspect, 1.0f, 1e8f);
+    return proj * glm::lookAt(c.position, c.position + c.front, c.up);
+}
 
-    if (gradient_cumulonimbus) {
-        Bind2D(*gradient_cumulonimbus, s,
-            { "GradientCumulonimbusTexture", "gradientCumulonimbusSampler", "gradientCumulonimbusTexture" },
-            unit++);
-    }
+void Init::bindTextures(Shader& s) {
+    ProfileZone zone(profiler.get(), "bind");
+    const ProgramBindings& b = bindingsFor(s);
+    if (b.count == 0) return;
+
+    GLState::get().bindTextures(b.firstUnit, b.count, &unitTextures[b.firstUnit]);
 }
 
 void Init::destroyTaaTargets() {
-    if (taaFbo) {
-        glDeleteFramebuffers(1, &taaFbo);
-        taaFbo = 0;
+    GLState& gl = GLState::get();
+    for (GLuint* fbo : { &taaFbo, &taaResolveFbo }) {
+        if (!*fbo) continue;
+        glDeleteFramebuffers(1, fbo);
+        gl.framebufferDeleted(*fbo);
+        *fbo = 0;
+    }
+    for (GLuint* tex : { &taaColor[0], &taaColor[1], &taaScene, &taaDepth }) {
+        if (!*tex) continue;
+        glDeleteTextures(1, tex);
+        gl.textureDeleted(*tex);
+        *tex = 0;
     }
-    if (taaColor[0]) glDeleteTextures(1, &taaColor[0]);
-    if (taaColor[1]) glDeleteTextures(1, &taaColor[1]);
-    taaColor[0] = taaColor[1] = 0;
     taaW = taaH = 0;
     taaHistoryValid = false;
     taaIndex = 0;
 }
 
 void Init::ensureTaaTargets(int w, int h) {
-    if (taaW == w && taaH == h && taaFbo && taaColor[0] && taaColor[1]) return;
+    if (taaW == w && taaH == h && taaFbo && taaResolveFbo && taaColor[0] && taaColor[1]) return;
 
     destroyTaaTargets();
 
     taaW = w;
     taaH = h;
 
-    glGenFramebuffers(1, &taaFbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, taaFbo);
-
-    glGenTextures(2, taaColor);
-    for (int i = 0; i < 2; ++i) {
-        glBindTexture(GL_TEXTURE_2D, taaColor[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // DSA throughout: creating the targets leaves every tracked binding untouched.
+    glCreateFramebuffers(1, &taaFbo);
+    glCreateFramebuffers(1, &taaResolveFbo);
+
+    // Resolved frames keep log2(1 + view distance) in alpha for the disocclusion test.
+    GLuint color[3];
+    glCreateTextures(GL_TEXTURE_2D, 3, color);
+    taaColor[0] = color[0];
+    taaColor[1] = color[1];
+    taaScene = color[2];
+    for (GLuint tex : color) {
+        glTextureStorage2D(tex, 1, GL_RGBA16F, w, h);
+        glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
 
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, taaColor[0], 0);
+    glCreateTextures(GL_TEXTURE_2D, 1, &taaDepth);
+    glTextureStorage2D(taaDepth, 1, GL_R32F, w, h);
+    glTextureParameteri(taaDepth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(taaDepth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glNamedFramebufferTexture(taaFbo, GL_COLOR_ATTACHMENT0, taaScene, 0);
+    glNamedFramebufferTexture(taaFbo, GL_COLOR_ATTACHMENT1, taaDepth, 0);
+    glNamedFramebufferTexture(taaResolveFbo, GL_COLOR_ATTACHMENT0, taaColor[0], 0);
 
-    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLenum status = glCheckNamedFramebufferStatus(taaFbo, GL_FRAMEBUFFER);
+    if (status == GL_FRAMEBUFFER_COMPLETE) status = glCheckNamedFramebufferStatus(taaResolveFbo, GL_FRAMEBUFFER);
 
     if (status != GL_FRAMEBUFFER_COMPLETE) {
         destroyTaaTargets();
@@ -568,67 +1389,345 @@ void Init::ensureTaaTargets(int w, int h) {
     }
 }
 
-void Init::renderSceneTo(GLuint fbo, Shader& s, int w, int h, float t, bool taaEnabledPass) {
-    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-    glViewport(0, 0, w, h);
+void Init::destroyCloudTargets() {
+    GLState& gl = GLState::get();
+    if (cloudFbo) {
+        glDeleteFramebuffers(1, &cloudFbo);
+        gl.framebufferDeleted(cloudFbo);
+        cloudFbo = 0;
+    }
+    if (cloudColor) {
+        glDeleteTextures(1, &cloudColor);
+        gl.textureDeleted(cloudColor);
+        cloudColor = 0;
+    }
+    if (cloudDepth) {
+        glDeleteTextures(1, &cloudDepth);
+        gl.textureDeleted(cloudDepth);
+        cloudDepth = 0;
+    }
+    unitTextures[kUnitCloudLowRes] = 0;
+    unitTextures[kUnitCloudDepth] = 0;
+    cloudW = cloudH = 0;
+}
+
+void Init::ensureCloudTargets(int w, int h) {
+    if (cloudW == w && cloudH == h && cloudFbo && cloudColor && cloudDepth) return;
+
+    destroyCloudTargets();
+
+    cloudW = w;
+    cloudH = h;
+
+    glCreateFramebuffers(1, &cloudFbo);
+
+    // Premultiplied color + coverage; the upsample fetches texels, so no filtering.
+    glCreateTextures(GL_TEXTURE_2D, 1, &cloudColor);
+    glTextureStorage2D(cloudColor, 1, GL_RGBA16F, w, h);
+    glTextureParameteri(cloudColor, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(cloudColor, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(cloudColor, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(cloudColor, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Cloud distance per texel, read back by the interleaved reprojection.
+    glCreateTextures(GL_TEXTURE_2D, 1, &cloudDepth);
+    glTextureStorage2D(cloudDepth, 1, GL_R32F, w, h);
+    glTextureParameteri(cloudDepth, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(cloudDepth, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(cloudDepth, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(cloudDepth, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glNamedFramebufferTexture(cloudFbo, GL_COLOR_ATTACHMENT0, cloudColor, 0);
+    glNamedFramebufferTexture(cloudFbo, GL_COLOR_ATTACHMENT1, cloudDepth, 0);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glNamedFramebufferDrawBuffers(cloudFbo, 2, drawBuffers);
+
+    if (glCheckNamedFramebufferStatus(cloudFbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        destroyCloudTargets();
+        throw std::runtime_error("cloud framebuffer incomplete");
+    }
+    unitTextures[kUnitCloudLowRes] = cloudColor;
+    unitTextures[kUnitCloudDepth] = cloudDepth;
+}
+
+void Init::destroyCloudHistory() {
+    GLState& gl = GLState::get();
+    if (cloudHistoryFbo) {
+        glDeleteFramebuffers(1, &cloudHistoryFbo);
+        gl.framebufferDeleted(cloudHistoryFbo);
+        cloudHistoryFbo = 0;
+    }
+    for (GLuint& tex : cloudHistory) {
+        if (!tex) continue;
+        glDeleteTextures(1, &tex);
+        gl.textureDeleted(tex);
+        tex = 0;
+    }
+    unitTextures[kUnitCloudHistory] = 0;
+    cloudHistoryW = cloudHistoryH = 0;
+    cloudHistoryValid = false;
+    cloudHistoryIndex = 0;
+}
 
-    glDisable(GL_SCISSOR_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_BLEND);
-    glDepthMask(GL_FALSE);
+void Init::ensureCloudHistory(int w, int h) {
+    if (cloudHistoryW == w && cloudHistoryH == h && cloudHistoryFbo && cloudHistory[0] && cloudHistory[1]) return;
+
+    destroyCloudHistory();
+
+    cloudHistoryW = w;
+    cloudHistoryH = h;
+
+    glCreateFramebuffers(1, &cloudHistoryFbo);
+
+    glCreateTextures(GL_TEXTURE_2D, 2, cloudHistory);
+    for (GLuint tex : cloudHistory) {
+        glTextureStorage2D(tex, 1, GL_RGBA16F, w, h);
+        glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    glNamedFramebufferTexture(cloudHistoryFbo, GL_COLOR_ATTACHMENT0, cloudHistory[0], 0);
+
+    if (glCheckNamedFramebufferStatus(cloudHistoryFbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        destroyCloudHistory();
+        throw std::runtime_error("cloud history framebuffer incomplete");
+    }
+}
+
+bool Init::renderInterleavedClouds(Shader& clouds, GLuint fbo, int w, int h) {
+    Shader* reproject = requestProgram(cloudReprojectShader, "cloud_reproject.glsl");
+    Shader* composite = requestProgram(cloudCompositeShader, "cloud_composite.glsl");
+    if (!reproject || !composite) return false;
+
+    try {
+        ensureCloudTargets((w + 3) / 4, (h + 3) / 4);
+        ensureCloudHistory(w, h);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "[clouds] %s, interleaving off\n", e.what());
+        cloudInterleave = false;
+        return false;
+    }
+
+    // Ordered-dither (Bayer) sequence: every 4 frames cover each 2x2 quadrant once and
+    // consecutive samples land far apart, so partially refreshed blocks stay even.
+    static const int kOrder[16][2] = {
+        { 0, 0 }, { 2, 2 }, { 2, 0 }, { 0, 2 }, { 1, 1 }, { 3, 3 }, { 3, 1 }, { 1, 3 },
+        { 1, 0 }, { 3, 2 }, { 3, 0 }, { 1, 2 }, { 0, 1 }, { 2, 3 }, { 2, 1 }, { 0, 3 }
+    };
+    const int* offset = kOrder[cloudInterleaveFrame++ % 16];
+    const glm::vec2 blockOffset((float)offset[0], (float)offset[1]);
+
+    // 1. This frame's pixel of every block.
+    {
+        ProfileZone zone(profiler.get(), "clouds.march");
+        const CloudUniforms& marchUniforms = cloudUniformsFor(clouds);
+        marchUniforms.pixelScale.set(4.0f);
+        marchUniforms.pixelOffset.set(blockOffset + glm::vec2(0.5f));
+
+        ResetFullscreenState(cloudW, cloudH, cloudFbo);
+        ClearTransparent();
+        clouds.use();
+        bindTextures(clouds);
+        quad->RenderMesh();
+    }
+
+    // 2. Fresh pixels + the rest reprojected from the previous frame.
+    const int cur = cloudHistoryIndex;
+    glNamedFramebufferTexture(cloudHistoryFbo, GL_COLOR_ATTACHMENT0, cloudHistory[cur], 0);
+    unitTextures[kUnitCloudHistory] = cloudHistory[1 - cur];
+
+    const CloudUniforms& reprojectUniforms = cloudUniformsFor(*reproject);
+    reprojectUniforms.pixelOffset.set(blockOffset);
+    reprojectUniforms.historyValid.set(cloudHistoryValid);
+
+    {
+        ProfileZone zone(profiler.get(), "clouds.reproject");
+        ResetFullscreenState(w, h, cloudHistoryFbo);
+        reproject->use();
+        bindTextures(*reproject);
+        quad->RenderMesh();
+    }
 
-    glClearColor(0.f, 0.f, 0.f, 1.f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    // 3. Over the scene.
+    unitTextures[kUnitCloudHistory] = cloudHistory[cur];
 
-    glUseProgram(s.ID);
-    bindCommonUniforms(s, w, h, t, taaEnabledPass);
+    {
+        ProfileZone zone(profiler.get(), "clouds.composite");
+        ResetFullscreenState(w, h, fbo);
+        GLState::get().setEnabled(GL_BLEND, true);
+        GLState::get().blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        composite->use();
+        bindTextures(*composite);
+        quad->RenderMesh();
+        GLState::get().setEnabled(GL_BLEND, false);
+    }
+
+    cloudHistoryIndex = 1 - cur;
+    cloudHistoryValid = true;
+    return true;
+}
+
+void Init::renderCloudOverlay(Shader& clouds, GLuint fbo, int w, int h) {
+    if (cloudInterleave && renderInterleavedClouds(clouds, fbo, w, h)) return;
+    // Anything drawn without the history leaves it stale.
+    cloudHistoryValid = false;
+
+    Shader* upsample = cloudDownsample > 1 ? requestProgram(cloudUpsampleShader, "cloud_upsample.glsl") : nullptr;
+    if (upsample) {
+        try {
+            ensureCloudTargets((w + cloudDownsample - 1) / cloudDownsample, (h + cloudDownsample - 1) / cloudDownsample);
+        }
+        catch (const std::exception& e) {
+            std::fprintf(stderr, "[clouds] %s, drawing at full resolution\n", e.what());
+            cloudDownsample = 1;
+            upsample = nullptr;
+        }
+    }
+
+    const float pixelScale = upsample ? (float)cloudDownsample : 1.0f;
+    const CloudUniforms& marchUniforms = cloudUniformsFor(clouds);
+    marchUniforms.pixelScale.set(pixelScale);
+    marchUniforms.pixelOffset.set(glm::vec2(pixelScale * 0.5f));
+
+    if (upsample) {
+        ProfileZone zone(profiler.get(), "clouds.march");
+        ResetFullscreenState(cloudW, cloudH, cloudFbo);
+        ClearTransparent();
+
+        clouds.use();
+        bindTextures(clouds);
+        quad->RenderMesh();
+
+        ResetFullscreenState(w, h, fbo);
+    }
+
+    ProfileZone zone(profiler.get(), upsample ? "clouds.upsample" : "clouds.march");
+
+    GLState::get().setEnabled(GL_BLEND, true);
+    GLState::get().blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    if (upsample) {
+        cloudUniformsFor(*upsample).pixelScale.set(pixelScale);
+        upsample->use();
+        bindTextures(*upsample);
+    }
+    else {
+        clouds.use();
+        bindTextures(clouds);
+    }
+    quad->RenderMesh();
+
+    GLState::get().setEnabled(GL_BLEND, false);
+}
+
+void Init::destroyUpscaleTarget() {
+    GLState& gl = GLState::get();
+    if (upscaleFbo) {
+        glDeleteFramebuffers(1, &upscaleFbo);
+        gl.framebufferDeleted(upscaleFbo);
+        upscaleFbo = 0;
+    }
+    if (upscaleColor) {
+        glDeleteTextures(1, &upscaleColor);
+        gl.textureDeleted(upscaleColor);
+        upscaleColor = 0;
+    }
+    upscaleW = upscaleH = 0;
+}
+
+void Init::ensureUpscaleTarget(int w, int h) {
+    if (upscaleW == w && upscaleH == h && upscaleFbo && upscaleColor) return;
+
+    destroyUpscaleTarget();
+
+    upscaleW = w;
+    upscaleH = h;
+
+    glCreateFramebuffers(1, &upscaleFbo);
+    glCreateTextures(GL_TEXTURE_2D, 1, &upscaleColor);
+    glTextureStorage2D(upscaleColor, 1, GL_RGBA8, w, h);
+    glNamedFramebufferTexture(upscaleFbo, GL_COLOR_ATTACHMENT0, upscaleColor, 0);
+
+    if (glCheckNamedFramebufferStatus(upscaleFbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        destroyUpscaleTarget();
+        throw std::runtime_error("upscale framebuffer incomplete");
+    }
+}
+
+void Init::present(int windowW, int windowH) {
+    if (presentFbo) {
+        PassScope pass(profiler.get(), governor.get(), "upscale");
+        ResetFullscreenState(windowW, windowH);
+        glBlitNamedFramebuffer(presentFbo, 0, 0, 0, upscaleW, upscaleH, 0, 0, windowW, windowH, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+    ProfileZone zone(profiler.get(), "swap");
+    swapBuffersAndPollEvents();
+}
+
+void Init::renderSceneTo(GLuint fbo, Shader& s, int w, int h) {
+    ResetFullscreenState(w, h, fbo);
+    ClearColorOnly();
+
+    // Single-pass modes write no distance: everything counts as far away, so TAA
+    // reprojects by the camera rotation alone.
+    if (fbo == taaFbo) {
+        // Cleared through the texture: draw buffer 1 may be off (fresh target, last frame).
+        const GLfloat far = kFarDistance;
+        glClearTexImage(taaDepth, 0, GL_RED, GL_FLOAT, &far);
+        const GLenum colorOnly[] = { GL_COLOR_ATTACHMENT0, GL_NONE };
+        glNamedFramebufferDrawBuffers(taaFbo, 2, colorOnly);
+    }
+
+    s.use();
     bindTextures(s);
 
     if (quad) quad->RenderMesh();
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void Init::renderTaaComposite(int w, int h) {
-    if (!taaShader || taaShader->ID == 0) return;
+    if (!taaShader || !taaShader->isReady()) return;
 
-    GLuint prog = taaShader->ID;
-    glUseProgram(prog);
+    taaShader->use();
 
-    GLint locRes = glGetUniformLocation(prog, "uResolution");
-    if (locRes != -1) glUniform2f(locRes, (float)w, (float)h);
+    const float aspect = (float)w / (float)h;
+    taaUniforms.resolution.set(glm::vec2((float)w, (float)h));
+    taaUniforms.viewProj.set(viewProjection(currentCamera, aspect));
+    taaUniforms.prevViewProj.set(viewProjection(previousCamera, aspect));
 
     float alpha = taaHistoryValid ? taaHistoryWeight : 0.0f;
-
-    GLint locAlpha = glGetUniformLocation(prog, "uAlpha");
-    if (locAlpha != -1) glUniform1f(locAlpha, alpha);
+    taaUniforms.alpha.set(alpha);
 
     int cur = taaIndex;
     int hist = 1 - taaIndex;
 
-    GLint locCur = glGetUniformLocation(prog, "uCurrent");
-    GLint locHist = glGetUniformLocation(prog, "uHistory");
-    if (locCur != -1) glUniform1i(locCur, 0);
-    if (locHist != -1) glUniform1i(locHist, 1);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, taaColor[cur]);
+    unitTextures[kUnitTaaCurrent] = taaScene;
+    unitTextures[kUnitTaaHistory] = taaColor[hist];
+    unitTextures[kUnitTaaDepth] = taaDepth;
+    bindTextures(*taaShader);
 
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, taaColor[hist]);
+    // Written into the history ring, then copied to the frame being presented.
+    {
+        ProfileZone zone(profiler.get(), "taa.resolve");
+        glNamedFramebufferTexture(taaResolveFbo, GL_COLOR_ATTACHMENT0, taaColor[cur], 0);
+        ResetFullscreenState(w, h, taaResolveFbo);
 
-    ResetFullscreenState(w, h);
-    ClearColorOnly();
+        if (quad) quad->RenderMesh();
+    }
 
-    if (quad) quad->RenderMesh();
+    ProfileZone zone(profiler.get(), "taa.blit");
+    glBlitNamedFramebuffer(taaResolveFbo, presentFbo, 0, 0, w, h, 0, 0, w, h, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
     taaHistoryValid = true;
     taaIndex = hist;
 }
 
 void Init::render() {
+    GLState::get().beginFrame();
+    if (profiler) profiler->beginFrame();
+    ProfileZone frameZone(profiler.get(), "frame");
     processInput(getWindow());
 
     int w = 0, h = 0;
@@ -640,34 +1739,88 @@ void Init::render() {
 
     float t = (float)glfwGetTime();
 
+    {
+        ProfileZone zone(profiler.get(), "pump");
+        pumpShaderBuilds();
+        pumpTextureUploads();
+        pumpNoiseChecks();
+    }
+
+    // The current mode and tier keep rendering until every program of the requested ones is linked.
+    if (requestedShader != activeShader || requestedQuality != activeQuality) {
+        if (requestMode(requestedShader, requestedQuality)) {
+            if (requestedQuality != activeQuality) {
+                std::fprintf(stderr, "[shaders] cloud quality: %s\n", cloudQualityName(requestedQuality));
+            }
+            activeShader = requestedShader;
+            activeQuality = requestedQuality;
+        }
+        else if (modeFailed(requestedShader, requestedQuality)) {
+            std::fprintf(stderr, "Mode %d (%s quality) unavailable, staying on mode %d (%s quality)\n",
+                requestedShader, cloudQualityName(requestedQuality), activeShader, cloudQualityName(activeQuality));
+            requestedShader = activeShader;
+            requestedQuality = activeQuality;
+        }
+    }
+    const bool modeReady = requestMode(activeShader, activeQuality);
+    const std::vector<ProgramRequest> programs = modePrograms(activeShader, activeQuality);
+
+    const bool taaActive = taaEnabled && requestProgram(taaShader, "ttafrag.glsl") != nullptr;
+
+    // Dynamic resolution: everything below renders at w x h, into the upscale target when
+    // that is smaller than the window; present() stretches it over the window.
+    const int windowW = w, windowH = h;
+    presentFbo = 0;
+    if (governor) {
+        governor->beginFrame();
+        const float scale = governor->getScale();
+        const int rw = std::max(1, (int)std::lround(w * scale));
+        const int rh = std::max(1, (int)std::lround(h * scale));
+        if (rw != w || rh != h) {
+            try {
+                ensureUpscaleTarget(rw, rh);
+                presentFbo = upscaleFbo;
+                w = rw;
+                h = rh;
+            }
+            catch (const std::exception& e) {
+                std::fprintf(stderr, "[resolution] %s, staying at full resolution\n", e.what());
+                governor->setEnabled(false);
+            }
+        }
+    }
+    ResolutionGovernor* timer = governor.get();
+    Profiler* zones = profiler.get();
+
     if (activeShader == 8) {
-        if (!watersky || watersky->ID == 0 || !cloudsOver || cloudsOver->ID == 0 || !quad) {
+        Shader* sky = programs[0].slot->get();
+        Shader* clouds = programs[1].slot->get();
+
+        if (!modeReady || !quad) {
             swapBuffersAndPollEvents();
             return;
         }
 
         frameCounter++;
 
-        if (!taaEnabled) {
-            ResetFullscreenState(w, h);
-            ClearColorOnly();
-
-            glUseProgram(watersky->ID);
-            bindCommonUniforms(*watersky, w, h, t, false);
-            bindTextures(*watersky);
-            quad->RenderMesh();
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-            glUseProgram(cloudsOver->ID);
-            bindCommonUniforms(*cloudsOver, w, h, t, false);
-            bindTextures(*cloudsOver);
-            quad->RenderMesh();
+        if (!taaActive) {
+            uploadFrameData(w, h, t, false);
 
-            glDisable(GL_BLEND);
+            ResetFullscreenState(w, h, presentFbo);
+            ClearColorOnly();
 
-            swapBuffersAndPollEvents();
+            {
+                PassScope pass(zones, timer, "sky");
+                sky->use();
+                bindTextures(*sky);
+                quad->RenderMesh();
+            }
+            {
+                PassScope pass(zones, timer, "clouds");
+                renderCloudOverlay(*clouds, presentFbo, w, h);
+            }
+
+            present(windowW, windowH);
             return;
         }
 
@@ -681,73 +1834,59 @@ void Init::render() {
             return;
         }
 
-        int cur = taaIndex;
-        glBindFramebuffer(GL_FRAMEBUFFER, taaFbo);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, taaColor[cur], 0);
-
-        glViewport(0, 0, w, h);
-        glDisable(GL_SCISSOR_TEST);
-        glDisable(GL_STENCIL_TEST);
-        glDisable(GL_CULL_FACE);
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_BLEND);
-        glDepthMask(GL_FALSE);
+        uploadFrameData(w, h, t, true);
 
-        glClearColor(0.f, 0.f, 0.f, 1.f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(watersky->ID);
-        bindCommonUniforms(*watersky, w, h, t, true);
-        bindTextures(*watersky);
-        quad->RenderMesh();
+        // The sky writes the ocean distance and the cloud overlay blends its own over it.
+        const GLenum colorAndDepth[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glNamedFramebufferDrawBuffers(taaFbo, 2, colorAndDepth);
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-        glUseProgram(cloudsOver->ID);
-        bindCommonUniforms(*cloudsOver, w, h, t, true);
-        bindTextures(*cloudsOver);
-        quad->RenderMesh();
-
-        glDisable(GL_BLEND);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        ResetFullscreenState(w, h, taaFbo);
+        ClearColorOnly();
 
-        renderTaaComposite(w, h);
+        {
+            PassScope pass(zones, timer, "sky");
+            sky->use();
+            bindTextures(*sky);
+            quad->RenderMesh();
+        }
+        {
+            PassScope pass(zones, timer, "clouds");
+            renderCloudOverlay(*clouds, taaFbo, w, h);
+        }
+        {
+            PassScope pass(zones, timer, "taa");
+            renderTaaComposite(w, h);
+        }
 
-        swapBuffersAndPollEvents();
+        present(windowW, windowH);
         return;
     }
 
-    Shader* s = nullptr;
-    switch (activeShader) {
-    case 1: s = shader.get(); break;
-    case 2: s = fragmentv2.get(); break;
-    case 3: s = rmarching.get(); break;
-    case 4: s = rmarching2.get(); break;
-    case 5: s = singlecloudfrag.get(); break;
-    case 6: s = water.get(); break;
-    case 7: s = watersky.get(); break;
-    default: s = watersky.get(); break;
-    }
+    // The interleaved clouds restart from scratch when mode 8 comes back.
+    cloudHistoryValid = false;
 
-    if (!s || s->ID == 0 || !quad) {
+    Shader* s = programs.front().slot->get();
+
+    if (!s || !modeReady || !quad) {
         swapBuffersAndPollEvents();
         return;
     }
 
-    if (!taaEnabled) {
+    if (!taaActive) {
         frameCounter++;
+        uploadFrameData(w, h, t, false);
 
-        ResetFullscreenState(w, h);
+        ResetFullscreenState(w, h, presentFbo);
         ClearColorOnly();
 
-        glUseProgram(s->ID);
-        bindCommonUniforms(*s, w, h, t, false);
-        bindTextures(*s);
-        quad->RenderMesh();
+        {
+            PassScope pass(zones, timer, "scene");
+            s->use();
+            bindTextures(*s);
+            quad->RenderMesh();
+        }
 
-        swapBuffersAndPollEvents();
+        present(windowW, windowH);
         return;
     }
 
@@ -761,17 +1900,19 @@ void Init::render() {
         return;
     }
 
-    int cur = taaIndex;
-    glBindFramebuffer(GL_FRAMEBUFFER, taaFbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, taaColor[cur], 0);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
     frameCounter++;
+    uploadFrameData(w, h, t, true);
 
-    renderSceneTo(taaFbo, *s, w, h, t, true);
-    renderTaaComposite(w, h);
+    {
+        PassScope pass(zones, timer, "scene");
+        renderSceneTo(taaFbo, *s, w, h);
+    }
+    {
+        PassScope pass(zones, timer, "taa");
+        renderTaaComposite(w, h);
+    }
 
-    swapBuffersAndPollEvents();
+    present(windowW, windowH);
 }
 
 void Init::cursorPosCallback(GLFWwindow*, double xpos, double ypos) {
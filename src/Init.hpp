@@ -10,12 +10,28 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <utility>
+#include <chrono>
 
 #include "Window.hpp"
 #include "Camera.hpp"
 #include "Mesh.hpp"
 #include "Shader.hpp"
 #include "Texture.hpp"
+#include "TextureStreamer.hpp"
+#include "TextureRegistry.hpp"
+#include "GLLoader.hpp"
+#include "ResolutionGovernor.hpp"
+#include "Profiler.hpp"
+#include "FrameUniforms.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "ShaderWatcher.hpp"
+#include "ThreadPool.hpp"
+#include "NoiseGenerator.hpp"
+#include "GpuNoise.hpp"
 
 class Init : public Window {
 public:
@@ -30,6 +46,48 @@ public:
     void initialize();
     void render();
 
+    // Cloud ray-march cost tiers. Each tier is a set of shader defines (step counts,
+    // light samples, erosion/curl on or off); High keeps the shaders' own defaults.
+    enum class CloudQuality { Low, Medium, High, Ultra };
+
+    // Takes effect once the tier's variants of the current mode have linked.
+    void setCloudQuality(CloudQuality quality);
+    CloudQuality getCloudQuality() const { return activeQuality; }
+
+    // Generate the cloud noise textures with compute shaders instead of loading them.
+    // Falls back to the files when compute is unavailable. Toggled at runtime with N.
+    void setGpuNoise(bool enabled);
+    bool getGpuNoise() const { return gpuNoiseEnabled; }
+    // Regenerates immediately when GPU noise is active; ',' / '.' halve / double it.
+    void setNoiseResolution(const GpuNoise::Resolution& resolution);
+    const GpuNoise::Resolution& getNoiseResolution() const { return noiseResolution; }
+
+    // GL memory the texture cache may keep; unused textures beyond it are evicted.
+    void setTextureBudget(size_t bytes);
+    size_t getTextureBudget() const { return textureBudget; }
+
+    // Swaps the weather map (a file under textures/); the current one stays bound until
+    // the new one is uploaded.
+    void setWeatherMap(const std::string& file);
+    const std::string& getWeatherMap() const { return weatherMapFile; }
+
+    // Mode 8 ray-marches the clouds at 1/factor of the window per axis (1, 2 or 4) and
+    // upsamples them against the ocean distance before compositing. Cycled with C.
+    void setCloudDownsample(int factor);
+    int getCloudDownsample() const { return cloudDownsample; }
+
+    // Mode 8 marches one pixel of every 4x4 block per frame and reprojects the other 15
+    // from the previous frame's full-resolution clouds. Overrides the downsample factor
+    // while on. Toggled with I.
+    void setCloudInterleave(bool enabled);
+    bool getCloudInterleave() const { return cloudInterleave; }
+
+    // GPU time per frame the dynamic resolution governor aims for; 0 = the monitor's
+    // refresh interval. The scene renders at a reduced internal resolution (down to
+    // ResolutionGovernor::kMinScale per axis) and is upscaled to the window. Toggled with R.
+    void setFrameBudget(double ms);
+    double getFrameBudget() const { return frameBudgetMs; }
+
     void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
     void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
     void processInput(GLFWwindow* window);
@@ -52,38 +110,140 @@ private:
     std::unique_ptr<Mesh> CreateQuad();
 
 private:
-    void bindCommonUniforms(Shader& s, int w, int h, float t, bool taaEnabled);
+    // Every texture has a fixed unit. Program samplers are pointed at these units once
+    // after link, so drawing never rewrites sampler uniforms.
+    enum TextureUnit : GLuint {
+        kUnitLowFrequency = 0,
+        kUnitHighFrequency,
+        kUnitWeather,
+        kUnitCurl,
+        kUnitGradientStratus,
+        kUnitGradientCumulus,
+        kUnitGradientCumulonimbus,
+        kUnitTaaCurrent,
+        kUnitTaaHistory,
+        kUnitTaaDepth,
+        kUnitCloudLowRes,
+        kUnitCloudDepth,
+        kUnitCloudHistory,
+        kUnitCount
+    };
+
+    // Contiguous run of units a program samples from; count 0 = no samplers.
+    struct ProgramBindings {
+        GLuint firstUnit = 0;
+        GLsizei count = 0;
+    };
+
+    struct TaaUniforms {
+        Uniform<glm::vec2> resolution;
+        Uniform<float> alpha;
+        Uniform<glm::mat4> viewProj;
+        Uniform<glm::mat4> prevViewProj;
+    };
+
+    // Cloud pass uniforms, per program: the mode programs (one per quality variant) and
+    // the upsample / reproject passes.
+    struct CloudUniforms {
+        Uniform<float> pixelScale;
+        Uniform<glm::vec2> pixelOffset;
+        Uniform<bool> historyValid;  // cloud_reproject
+    };
+
+    const ProgramBindings& bindingsFor(const Shader& s);
+    const CloudUniforms& cloudUniformsFor(const Shader& s);
+    void createSamplers();
+    void destroySamplers();
+
+    struct ProgramRequest {
+        std::unique_ptr<Shader>* slot;
+        const char* frag;
+        ShaderDefines defines;
+    };
+
+    static ShaderDefines cloudQualityDefines(CloudQuality quality);
+    static const char* cloudQualityName(CloudQuality quality);
+
+    // Programs are built lazily: a mode's programs are submitted together on first
+    // selection and polled each frame; the previous mode renders until they link.
+    std::vector<ProgramRequest> modePrograms(int mode, CloudQuality quality);
+    std::unique_ptr<Shader>& variantSlot(const char* frag, const ShaderDefines& defines);
+    Shader* requestVertexStage();
+    Shader* requestProgram(std::unique_ptr<Shader>& dst, const char* frag, const ShaderDefines& defines = {});
+    bool requestMode(int mode, CloudQuality quality);
+    bool modeFailed(int mode, CloudQuality quality);
+    void onProgramReady(std::unique_ptr<Shader>& slot);
+    std::vector<std::unique_ptr<Shader>*> programSlots();
+    void pumpShaderBuilds();
+
+    // With a GLLoader, programs are compiled and linked on its thread and handed over
+    // finished; otherwise they are built deferred here. Failures land in failedShaderFiles.
+    void startProgramBuild(std::unique_ptr<Shader>& slot, GLenum stage, const std::string& path,
+        const ShaderDefines& defines, const std::string& failKey, bool reload = false);
+    void pumpProgramLoads();
+
+    // Hot reload: programs built from a changed file are recompiled (deferred) next to
+    // the running one and swapped in once linked; on failure the old program stays.
+    void pumpShaderReloads();
+    void startShaderReload(std::unique_ptr<Shader>& slot);
+
+    // Uploads every texture whose worker decode has finished: on the GLLoader thread when
+    // there is one, otherwise streamed from this thread.
+    void pumpTextureUploads();
+
+    // Fills FrameData once per frame; every program reads it through the shared block.
+    void uploadFrameData(int w, int h, float t, bool taaEnabled);
     void bindTextures(Shader& s);
 
 private:
     void ensureTaaTargets(int w, int h);
     void destroyTaaTargets();
-    void renderSceneTo(GLuint fbo, Shader& s, int w, int h, float t, bool taaEnabled);
+    void renderSceneTo(GLuint fbo, Shader& s, int w, int h);
+    // Reprojects the resolved history by the camera motion between the two frames and the
+    // per-pixel scene depth, blends it with the new frame and presents the result.
     void renderTaaComposite(int w, int h);
 
+    // Internal-resolution target for dynamic resolution, stretched over the window by present().
+    void ensureUpscaleTarget(int w, int h);
+    void destroyUpscaleTarget();
+    void present(int windowW, int windowH);
+
+    void ensureCloudTargets(int w, int h);
+    void destroyCloudTargets();
+    // Blends the clouds over whatever fbo holds: drawn directly at full resolution, or
+    // into cloudFbo and upsampled when a reduced resolution is selected and available.
+    void renderCloudOverlay(Shader& clouds, GLuint fbo, int w, int h);
+
+    void ensureCloudHistory(int w, int h);
+    void destroyCloudHistory();
+    // Interleaved march + reprojection into cloudHistory, composited over fbo. False when
+    // its programs or targets are unavailable (the caller then draws the clouds normally).
+    bool renderInterleavedClouds(Shader& clouds, GLuint fbo, int w, int h);
+
 private:
     std::unique_ptr<Camera> camera;
 
+    // separable fullscreen vertex stage shared by every fragment program below
+    std::unique_ptr<Shader> fullscreenVertex;
+
     // single-pass shaders
     std::unique_ptr<Shader> shader;
     std::unique_ptr<Shader> fragmentv2;
-    std::unique_ptr<Shader> rmarching;
-    std::unique_ptr<Shader> rmarching2;
-    std::unique_ptr<Shader> singlecloudfrag;
     std::unique_ptr<Shader> water;
     std::unique_ptr<Shader> watersky;
 
-    // overlay clouds (alpha) for combined mode
-    std::unique_ptr<Shader> cloudsOver;
+    // cloud programs (ray marching, single cloud, combined-mode overlay), one per
+    // source + quality defines, keyed "file|NAME=VALUE;..."
+    std::unordered_map<std::string, std::unique_ptr<Shader>> programVariants;
 
-    // textures
-    std::unique_ptr<Texture> lowfreq3D;
-    std::unique_ptr<Texture> highfreq3D;
-    std::unique_ptr<Texture> weathermap2D;
-    std::unique_ptr<Texture> curlnoise2D;
-    std::unique_ptr<Texture> gradient_stratus;
-    std::unique_ptr<Texture> gradient_cumulus;
-    std::unique_ptr<Texture> gradient_cumulonimbus;
+    // textures (shared with textureRegistry)
+    std::shared_ptr<Texture> lowfreq3D;
+    std::shared_ptr<Texture> highfreq3D;
+    std::shared_ptr<Texture> weathermap2D;
+    std::shared_ptr<Texture> curlnoise2D;
+    std::shared_ptr<Texture> gradient_stratus;
+    std::shared_ptr<Texture> gradient_cumulus;
+    std::shared_ptr<Texture> gradient_cumulonimbus;
 
     // meshes
     std::unique_ptr<Mesh> triangle;
@@ -103,6 +263,10 @@ private:
 
     // 1..7 =   , 8 = OCEAN+SKY + CLOUDS OVERLAY
     int activeShader = 8;
+    int requestedShader = 8;
+
+    CloudQuality activeQuality = CloudQuality::High;
+    CloudQuality requestedQuality = CloudQuality::High;
 
     // combined cloud heights (meters)
     float cloudBottom = 300.0f;
@@ -118,11 +282,151 @@ private:
     bool taaHistoryValid = false;
 
     std::unique_ptr<Shader> taaShader;
+    // scene pass: color + view distance (ocean / clouds, coverage weighted)
     GLuint taaFbo = 0;
+    GLuint taaScene = 0;
+    GLuint taaDepth = 0;
+    // resolved frames, ping-pong: one is written while the other is the history
+    GLuint taaResolveFbo = 0;
     GLuint taaColor[2] = { 0, 0 };
     int taaIndex = 0;
     int taaW = 0;
     int taaH = 0;
 
+    // Reduced-resolution clouds (mode 8)
+    int cloudDownsample = 2;
+    std::unique_ptr<Shader> cloudUpsampleShader;
+    GLuint cloudFbo = 0;
+    GLuint cloudColor = 0;
+    GLuint cloudDepth = 0;
+    int cloudW = 0;
+    int cloudH = 0;
+
+    // Interleaved clouds: full-resolution ping-pong history
+    bool cloudInterleave = false;
+    std::unique_ptr<Shader> cloudReprojectShader;
+    std::unique_ptr<Shader> cloudCompositeShader;
+    GLuint cloudHistoryFbo = 0;
+    GLuint cloudHistory[2] = { 0, 0 };
+    int cloudHistoryIndex = 0;
+    int cloudHistoryW = 0;
+    int cloudHistoryH = 0;
+    bool cloudHistoryValid = false;
+    uint32_t cloudInterleaveFrame = 0;
+
+    // Camera of this frame and the one before (FrameData.prevCamera*)
+    struct CameraFrame {
+        glm::vec3 position{ 0.0f };
+        glm::vec3 front{ 0.0f, 0.0f, -1.0f };
+        glm::vec3 up{ 0.0f, 1.0f, 0.0f };
+        glm::vec3 right{ 1.0f, 0.0f, 0.0f };
+    };
+    // Matches cameraRayDirectionAt() in common.glsl.
+    static glm::mat4 viewProjection(const CameraFrame& camera, float aspect);
+    CameraFrame currentCamera;
+    CameraFrame previousCamera;
+    bool hasPreviousCamera = false;
+
+    // CPU/GPU zones around every pass; P prints the statistics and writes a Chrome trace.
+    std::unique_ptr<Profiler> profiler;
+
+    // Dynamic resolution: frames go to presentFbo (0, or upscaleFbo when scaled down).
+    std::unique_ptr<ResolutionGovernor> governor;
+    double frameBudgetMs = 0.0;
+    GLuint presentFbo = 0;
+    GLuint upscaleFbo = 0;
+    GLuint upscaleColor = 0;
+    int upscaleW = 0;
+    int upscaleH = 0;
+
     uint64_t frameCounter = 0;
+
+    std::unique_ptr<FrameUniformBuffer> frameUniforms;
+    std::unique_ptr<ProgramBinaryCache> programCache;
+    std::unordered_set<std::string> failedShaderFiles;
+    std::unique_ptr<ShaderWatcher> shaderWatcher;
+    std::unordered_map<std::unique_ptr<Shader>*, std::unique_ptr<Shader>> shaderReloads;
+    std::chrono::steady_clock::time_point shaderStart;
+    bool shaderStartReported = false;
+
+    // A texture uploaded by the GLLoader; null on failure.
+    struct LoadedTexture {
+        std::unique_ptr<Texture> texture;
+        size_t bytes = 0;
+        double uploadMs = 0.0;
+        std::string error;
+    };
+
+    struct PendingTexture {
+        std::shared_ptr<Texture>* dst;
+        TextureUnit unit;
+        std::string file;
+        TextureImport import;
+        std::string key;                  // TextureRegistry key
+        std::future<TextureData> decode;  // invalid while waiting for another unit's load of the key
+        std::unique_ptr<TextureStream> stream;  // set once decoded; the old texture stays bound until it is done
+        std::future<LoadedTexture> load;  // instead of stream when the GLLoader uploads it
+
+        bool inFlight() const { return decode.valid() || stream || load.valid(); }
+    };
+
+    void publishTexture(PendingTexture& pending, std::unique_ptr<Texture> texture, size_t bytes);
+
+    // Import settings of a file-backed unit; its sampler is derived from the same mips/wrap.
+    static TextureImport unitImport(TextureUnit unit);
+    void queueTexture(std::shared_ptr<Texture>& dst, TextureUnit unit, const char* filename, const TextureImport& import,
+        const NoiseGenerator::Settings* generate = nullptr);
+    void queueNoiseTextures();
+    void queueFileTextures();
+    // Re-reads every file-backed texture (F5); the new ones stream in behind the current ones.
+    void reloadTextures();
+    bool generateGpuNoise();
+    void pumpNoiseChecks();
+
+    // GPU output read back once and compared against the CPU reference on the workers.
+    struct NoiseCheck {
+        const char* name;
+        std::vector<unsigned char> gpu;
+        std::future<std::vector<unsigned char>> cpu;
+    };
+
+    std::unique_ptr<GpuNoise> gpuNoise;
+    bool gpuNoiseEnabled = false;
+    GpuNoise::Resolution noiseResolution;
+    uint32_t noiseSeed = 1;
+#ifdef NDEBUG
+    bool verifyGpuNoise = false;
+#else
+    bool verifyGpuNoise = true;
+#endif
+    std::vector<NoiseCheck> noiseChecks;
+
+    std::unique_ptr<ThreadPool> workers;
+    std::vector<PendingTexture> pendingTextures;
+    std::unique_ptr<TextureStreamer> textureStreamer;
+    std::unique_ptr<TextureRegistry> textureRegistry;
+    std::string weatherMapFile = "weathermap.png";
+
+    struct ProgramLoad {
+        std::future<std::unique_ptr<Shader>> shader;
+        std::string failKey;
+        bool reload = false;  // becomes a hot-reload candidate instead of filling the slot
+    };
+    std::unordered_map<std::unique_ptr<Shader>*, ProgramLoad> programLoads;
+
+    // Thread on the hidden shared context (Window::getLoaderContext); null without one.
+    std::unique_ptr<GLLoader> loader;
+    size_t textureBudget = TextureRegistry::kDefaultBudget;
+    std::chrono::steady_clock::time_point textureStart;
+    double textureDecodeMs = 0.0;
+    double textureUploadMs = 0.0;
+
+    // keyed by program ID
+    std::unordered_map<GLuint, ProgramBindings> programBindings;
+    std::unordered_map<GLuint, CloudUniforms> cloudUniforms;
+
+    // texture and sampler object per fixed unit (0 = nothing bound)
+    GLuint unitTextures[kUnitCount] = {};
+    GLuint unitSamplers[kUnitCount] = {};
+    TaaUniforms taaUniforms;
 };
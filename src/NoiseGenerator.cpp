@@ -0,0 +1,393 @@
+#include "NoiseGenerator.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// The noise is written once as templates over a lane type: float/int32_t for the scalar
+// reference, F4/I4 (four consecutive x voxels) for SSE2. Both run the same operations in
+// the same order, so they produce bit-identical voxels.
+namespace {
+    // Keep every constant and operation below in step with shaders/include/noise_gen.glsl,
+    // which generates the same textures on the GPU.
+    constexpr int kWorleyOctaves = 5;
+    constexpr int kPerlinOctaves = 5;
+    constexpr int kCurlOctaves = 3;
+    constexpr float kCurlScale = 1.0f / 32.0f;
+
+    uint32_t MixSeed(uint32_t seed, uint32_t salt) {
+        uint32_t h = seed + salt * 0x9e3779b9u;
+        h ^= h >> 16; h *= 0x7feb352du;
+        h ^= h >> 15; h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // ---- scalar lanes ----
+
+    inline uint32_t HashCell(int32_t x, int32_t y, int32_t z, uint32_t seed) {
+        uint32_t h = seed ^ ((uint32_t)x * 0x8da6b343u) ^ ((uint32_t)y * 0xd8163841u) ^ ((uint32_t)z * 0xcb1ab31fu);
+        h ^= h >> 16; h *= 0x7feb352du;
+        h ^= h >> 15; h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+
+    inline int32_t FloorToInt(float x) { return (int32_t)std::floor(x); }
+    inline float ToFloat(int32_t x) { return (float)x; }
+    inline int32_t WrapCell(int32_t c, int32_t period) { return c < 0 ? c + period : (c >= period ? c - period : c); }
+    inline float Unit10(uint32_t h, int shift) { return (float)((h >> shift) & 1023u) * (1.0f / 1024.0f); }
+    inline float Min(float a, float b) { return a < b ? a : b; }
+    inline float Sqrt(float x) { return std::sqrt(x); }
+    inline float Saturate(float x) { return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x); }
+
+    // Improved-noise gradient: one of 12 cube-edge directions picked by the low hash bits.
+    inline float GradDot(uint32_t h, float x, float y, float z) {
+        const uint32_t hh = h & 15u;
+        const float u = hh < 8u ? x : y;
+        const float v = hh < 4u ? y : (hh == 12u || hh == 14u ? x : z);
+        return ((hh & 1u) ? -u : u) + ((hh & 2u) ? -v : v);
+    }
+
+#ifdef NOISE_SSE2
+    // ---- SSE2 lanes ----
+
+    struct F4 {
+        __m128 v;
+        F4() = default;
+        F4(__m128 v) : v(v) {}
+        F4(float s) : v(_mm_set1_ps(s)) {}
+    };
+    struct I4 {
+        __m128i v;
+        I4() = default;
+        I4(__m128i v) : v(v) {}
+        I4(int32_t s) : v(_mm_set1_epi32(s)) {}
+    };
+
+    inline F4 operator+(F4 a, F4 b) { return _mm_add_ps(a.v, b.v); }
+    inline F4 operator-(F4 a, F4 b) { return _mm_sub_ps(a.v, b.v); }
+    inline F4 operator*(F4 a, F4 b) { return _mm_mul_ps(a.v, b.v); }
+    inline I4 operator+(I4 a, I4 b) { return _mm_add_epi32(a.v, b.v); }
+
+    // SSE2 has no 32-bit low multiply; build it from two 32x32->64 multiplies.
+    inline __m128i MulLo(__m128i a, __m128i b) {
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    inline I4 HashCell(I4 x, I4 y, I4 z, uint32_t seed) {
+        __m128i h = _mm_set1_epi32((int32_t)seed);
+        h = _mm_xor_si128(h, MulLo(x.v, _mm_set1_epi32((int32_t)0x8da6b343u)));
+        h = _mm_xor_si128(h, MulLo(y.v, _mm_set1_epi32((int32_t)0xd8163841u)));
+        h = _mm_xor_si128(h, MulLo(z.v, _mm_set1_epi32((int32_t)0xcb1ab31fu)));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 16)); h = MulLo(h, _mm_set1_epi32((int32_t)0x7feb352du));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 15)); h = MulLo(h, _mm_set1_epi32((int32_t)0x846ca68bu));
+        h = _mm_xor_si128(h, _mm_srli_epi32(h, 16));
+        return h;
+    }
+
+    inline I4 FloorToInt(F4 x) {
+        const __m128i t = _mm_cvttps_epi32(x.v);
+        // truncation rounded negative values up; the all-ones mask subtracts one there
+        return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), x.v)));
+    }
+    inline F4 ToFloat(I4 x) { return _mm_cvtepi32_ps(x.v); }
+
+    inline I4 WrapCell(I4 c, int32_t period) {
+        const __m128i p = _mm_set1_epi32(period);
+        const __m128i below = _mm_cmplt_epi32(c.v, _mm_setzero_si128());
+        const __m128i above = _mm_cmpgt_epi32(c.v, _mm_set1_epi32(period - 1));
+        return _mm_sub_epi32(_mm_add_epi32(c.v, _mm_and_si128(below, p)), _mm_and_si128(above, p));
+    }
+
+    inline F4 Unit10(I4 h, int shift) {
+        const __m128i bits = _mm_and_si128(_mm_srl_epi32(h.v, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(1023));
+        return _mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(1.0f / 1024.0f));
+    }
+    inline F4 Min(F4 a, F4 b) { return _mm_min_ps(a.v, b.v); }
+    inline F4 Sqrt(F4 x) { return _mm_sqrt_ps(x.v); }
+    inline F4 Saturate(F4 x) { return _mm_min_ps(_mm_max_ps(x.v, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+
+    inline __m128 Select(__m128i mask, __m128 a, __m128 b) {
+        const __m128 m = _mm_castsi128_ps(mask);
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+
+    inline F4 GradDot(I4 h, F4 x, F4 y, F4 z) {
+        const __m128i hh = _mm_and_si128(h.v, _mm_set1_epi32(15));
+        const __m128i lt8 = _mm_cmplt_epi32(hh, _mm_set1_epi32(8));
+        const __m128i lt4 = _mm_cmplt_epi32(hh, _mm_set1_epi32(4));
+        const __m128i xz = _mm_or_si128(_mm_cmpeq_epi32(hh, _mm_set1_epi32(12)), _mm_cmpeq_epi32(hh, _mm_set1_epi32(14)));
+        const __m128 u = Select(lt8, x.v, y.v);
+        const __m128 v = Select(lt4, y.v, Select(xz, x.v, z.v));
+        // flip the sign bit where bit 0 / bit 1 is set
+        const __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hh, _mm_set1_epi32(1)), 31));
+        const __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(hh, _mm_set1_epi32(2)), 30));
+        return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+    }
+
+    inline void Store(F4 x, float* out) { _mm_storeu_ps(out, x.v); }
+#endif
+
+    inline void Store(float x, float* out) { *out = x; }
+
+    // ---- noise, shared by both lane types ----
+
+    // Distance to the nearest feature point, p in cell units on a `period`-cell torus.
+    // Feature points are quantized to 1/1024 of a cell so every implementation agrees.
+    template <typename F, typename I>
+    F Worley(F px, F py, F pz, int32_t period, uint32_t seed) {
+        const I cx = FloorToInt(px), cy = FloorToInt(py), cz = FloorToInt(pz);
+        const F fx = px - ToFloat(cx), fy = py - ToFloat(cy), fz = pz - ToFloat(cz);
+
+        F best = F(8.0f);
+        for (int32_t dz = -1; dz <= 1; ++dz) {
+            const I wz = WrapCell(cz + I(dz), period);
+            for (int32_t dy = -1; dy <= 1; ++dy) {
+                const I wy = WrapCell(cy + I(dy), period);
+                for (int32_t dx = -1; dx <= 1; ++dx) {
+                    const I h = HashCell(WrapCell(cx + I(dx), period), wy, wz, seed);
+                    const F ox = F((float)dx) + Unit10(h, 0) - fx;
+                    const F oy = F((float)dy) + Unit10(h, 10) - fy;
+                    const F oz = F((float)dz) + Unit10(h, 20) - fz;
+                    best = Min(best, ox * ox + oy * oy + oz * oz);
+                }
+            }
+        }
+        return Sqrt(best);
+    }
+
+    template <typename F>
+    F Lerp(F a, F b, F t) { return a + (b - a) * t; }
+
+    template <typename F>
+    F Fade(F t) { return t * t * t * (t * (t * F(6.0f) - F(15.0f)) + F(10.0f)); }
+
+    // Gradient noise in roughly [-1, 1], tiling every `period` cells.
+    template <typename F, typename I>
+    F Perlin(F px, F py, F pz, int32_t period, uint32_t seed) {
+        const I ix = FloorToInt(px), iy = FloorToInt(py), iz = FloorToInt(pz);
+        const F fx = px - ToFloat(ix), fy = py - ToFloat(iy), fz = pz - ToFloat(iz);
+        const I x0 = WrapCell(ix, period), x1 = WrapCell(ix + I(1), period);
+        const I y0 = WrapCell(iy, period), y1 = WrapCell(iy + I(1), period);
+        const I z0 = WrapCell(iz, period), z1 = WrapCell(iz + I(1), period);
+        const F gx = fx - F(1.0f), gy = fy - F(1.0f), gz = fz - F(1.0f);
+
+        const F n000 = GradDot(HashCell(x0, y0, z0, seed), fx, fy, fz);
+        const F n100 = GradDot(HashCell(x1, y0, z0, seed), gx, fy, fz);
+        const F n010 = GradDot(HashCell(x0, y1, z0, seed), fx, gy, fz);
+        const F n110 = GradDot(HashCell(x1, y1, z0, seed), gx, gy, fz);
+        const F n001 = GradDot(HashCell(x0, y0, z1, seed), fx, fy, gz);
+        const F n101 = GradDot(HashCell(x1, y0, z1, seed), gx, fy, gz);
+        const F n011 = GradDot(HashCell(x0, y1, z1, seed), fx, gy, gz);
+        const F n111 = GradDot(HashCell(x1, y1, z1, seed), gx, gy, gz);
+
+        const F ux = Fade(fx), uy = Fade(fy), uz = Fade(fz);
+        const F nx00 = Lerp(n000, n100, ux), nx10 = Lerp(n010, n110, ux);
+        const F nx01 = Lerp(n001, n101, ux), nx11 = Lerp(n011, n111, ux);
+        return Lerp(Lerp(nx00, nx10, uy), Lerp(nx01, nx11, uy), uz);
+    }
+
+    // RGBA in [0,1] for voxel centers (u, v, w) given in tile units.
+    template <typename F, typename I>
+    void Voxel(const NoiseGenerator::Settings& s, F u, F v, F w, F rgba[4]) {
+        const bool low = s.volume == NoiseGenerator::Volume::LowFrequency;
+        const int32_t baseFrequency = low ? 4 : 2;
+
+        // Inverted Worley per octave; channel k is the 3-octave FBM starting at octave k.
+        F worley[kWorleyOctaves];
+        for (int o = 0; o < kWorleyOctaves; ++o) {
+            const int32_t f = baseFrequency << o;
+            const F ff = F((float)f);
+            worley[o] = F(1.0f) - Saturate(Worley<F, I>(u * ff, v * ff, w * ff, f, MixSeed(s.seed, 0x100u + (uint32_t)o)));
+        }
+        F fbm[3];
+        for (int k = 0; k < 3; ++k) {
+            fbm[k] = worley[k] * F(0.625f) + worley[k + 1] * F(0.25f) + worley[k + 2] * F(0.125f);
+        }
+
+        if (low) {
+            F perlin = F(0.0f);
+            float amplitude = 1.0f, total = 0.0f;
+            for (int o = 0; o < kPerlinOctaves; ++o) {
+                const int32_t f = baseFrequency << o;
+                const F ff = F((float)f);
+                perlin = perlin + Perlin<F, I>(u * ff, v * ff, w * ff, f, MixSeed(s.seed, 0x200u + (uint32_t)o)) * F(amplitude);
+                total += amplitude;
+                amplitude *= 0.5f;
+            }
+            perlin = Saturate(perlin * F(0.5f / total) + F(0.5f));
+            // remap(perlin, 0, 1, worleyFBM, 1): Worley cells carve the billowy Perlin base
+            rgba[0] = fbm[0] + perlin * (F(1.0f) - fbm[0]);
+            rgba[1] = fbm[0];
+            rgba[2] = fbm[1];
+            rgba[3] = fbm[2];
+        }
+        else {
+            rgba[0] = fbm[0];
+            rgba[1] = fbm[1];
+            rgba[2] = fbm[2];
+            rgba[3] = F(1.0f);
+        }
+    }
+
+    // Curl potential at texel (x, y): 2D slice through 3D Perlin FBM.
+    float CurlPotential(uint32_t size, uint32_t seed, uint32_t x, uint32_t y) {
+        const float scale = 1.0f / (float)size;
+        const float u = ((float)x + 0.5f) * scale;
+        const float v = ((float)y + 0.5f) * scale;
+
+        float potential = 0.0f;
+        float amplitude = 1.0f;
+        for (int o = 0; o < kCurlOctaves; ++o) {
+            const int32_t f = 4 << o;
+            potential = potential + Perlin<float, int32_t>(u * (float)f, v * (float)f, 0.5f, f, MixSeed(seed, 0x300u + (uint32_t)o)) * amplitude;
+            amplitude *= 0.5f;
+        }
+        return potential;
+    }
+
+    inline unsigned char Quantize(float x) {
+        return (unsigned char)(std::min(std::max(x, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    template <typename F, typename I, int Lanes>
+    void GenerateSlab(const NoiseGenerator::Settings& s, uint32_t z0, uint32_t z1, unsigned char* out) {
+        const float scale = 1.0f / (float)s.size;
+        float lane[Lanes];
+        for (int i = 0; i < Lanes; ++i) lane[i] = (float)i;
+
+        for (uint32_t z = z0; z < z1; ++z) {
+            const F w = F(((float)z + 0.5f) * scale);
+            for (uint32_t y = 0; y < s.size; ++y) {
+                const F v = F(((float)y + 0.5f) * scale);
+                unsigned char* row = out + ((size_t)z * s.size + y) * s.size * 4;
+                for (uint32_t x = 0; x < s.size; x += Lanes) {
+                    F u;
+                    if constexpr (Lanes == 1) u = ((float)x + 0.5f) * scale;
+#ifdef NOISE_SSE2
+                    else u = (F((float)x) + F(_mm_loadu_ps(lane)) + F(0.5f)) * F(scale);
+#endif
+                    F rgba[4];
+                    Voxel<F, I>(s, u, v, w, rgba);
+
+                    float c[4][Lanes];
+                    for (int k = 0; k < 4; ++k) Store(rgba[k], c[k]);
+                    for (int i = 0; i < Lanes; ++i) {
+                        for (int k = 0; k < 4; ++k) row[(x + i) * 4 + k] = Quantize(c[k][i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool NoiseGenerator::HasSimd() {
+#ifdef NOISE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* NoiseGenerator::VolumeName(Volume volume) {
+    return volume == Volume::LowFrequency ? "low-frequency" : "high-frequency";
+}
+
+void NoiseGenerator::GenerateVoxel(const Settings& s, uint32_t x, uint32_t y, uint32_t z, unsigned char out[4]) {
+    const float scale = 1.0f / (float)s.size;
+    float rgba[4];
+    Voxel<float, int32_t>(s, ((float)x + 0.5f) * scale, ((float)y + 0.5f) * scale, ((float)z + 0.5f) * scale, rgba);
+    for (int k = 0; k < 4; ++k) out[k] = Quantize(rgba[k]);
+}
+
+std::vector<unsigned char> NoiseGenerator::Generate(const Settings& s, ThreadPool* pool) {
+    if (s.size < 4 || (s.size & (s.size - 1)) != 0) {
+        throw std::runtime_error("Noise volume size must be a power of two >= 4, got " + std::to_string(s.size));
+    }
+
+    std::vector<unsigned char> voxels((size_t)s.size * s.size * s.size * 4);
+
+    std::unique_ptr<ThreadPool> ownPool;
+    if (!pool) {
+        ownPool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        pool = ownPool.get();
+    }
+
+    // A few slabs per thread keeps the pool busy even when some finish early.
+    const uint32_t slabs = std::min(s.size, pool->size() * 4);
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(slabs);
+    for (uint32_t i = 0; i < slabs; ++i) {
+        const uint32_t z0 = s.size * i / slabs;
+        const uint32_t z1 = s.size * (i + 1) / slabs;
+        unsigned char* out = voxels.data();
+        jobs.push_back(pool->submit([s, z0, z1, out] {
+#ifdef NOISE_SSE2
+            if (s.simd) {
+                GenerateSlab<F4, I4, 4>(s, z0, z1, out);
+                return;
+            }
+#endif
+            GenerateSlab<float, int32_t, 1>(s, z0, z1, out);
+        }));
+    }
+    for (auto& job : jobs) job.get();
+
+    return voxels;
+}
+
+std::vector<unsigned char> NoiseGenerator::GenerateCurl(uint32_t size, uint32_t seed, ThreadPool* pool) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        throw std::runtime_error("Curl noise size must be a power of two >= 4, got " + std::to_string(size));
+    }
+
+    std::vector<unsigned char> texels((size_t)size * size * 4);
+
+    std::unique_ptr<ThreadPool> ownPool;
+    if (!pool) {
+        ownPool = std::make_unique<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+        pool = ownPool.get();
+    }
+
+    const uint32_t bands = std::min(size, pool->size() * 4);
+    std::vector<std::future<void>> jobs;
+    jobs.reserve(bands);
+    for (uint32_t i = 0; i < bands; ++i) {
+        const uint32_t y0 = size * i / bands;
+        const uint32_t y1 = size * (i + 1) / bands;
+        unsigned char* out = texels.data();
+        jobs.push_back(pool->submit([size, seed, y0, y1, out] {
+            const uint32_t mask = size - 1;
+            for (uint32_t y = y0; y < y1; ++y) {
+                for (uint32_t x = 0; x < size; ++x) {
+                    // central differences over the wrapped neighbours keep the result tileable
+                    const float dx = CurlPotential(size, seed, (x + 1) & mask, y) - CurlPotential(size, seed, (x - 1) & mask, y);
+                    const float dy = CurlPotential(size, seed, x, (y + 1) & mask) - CurlPotential(size, seed, x, (y - 1) & mask);
+                    const float cx = dy * (float)size * kCurlScale;
+                    const float cy = -dx * (float)size * kCurlScale;
+
+                    unsigned char* texel = out + ((size_t)y * size + x) * 4;
+                    texel[0] = Quantize(cx * 0.5f + 0.5f);
+                    texel[1] = Quantize(cy * 0.5f + 0.5f);
+                    texel[2] = 0;
+                    texel[3] = 255;
+                }
+            }
+        }));
+    }
+    for (auto& job : jobs) job.get();
+
+    return texels;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Tileable procedural 3D noise for the cloud shape textures. Output is RGBA8 with x
+// fastest, then y, then z, i.e. the width x width^2 strip layout LoadTexture3D reads
+// (and the voxel order of a .vol file). Results depend only on the settings, never on
+// thread count or whether the SIMD path is used.
+class NoiseGenerator {
+public:
+    enum class Volume {
+        LowFrequency,  // R = Perlin-Worley, GBA = Worley FBM at increasing frequency
+        HighFrequency, // RGB = Worley FBM at increasing frequency, A = 1
+    };
+
+    struct Settings {
+        Volume volume = Volume::LowFrequency;
+        uint32_t size = 128;   // power of two, >= 4
+        uint32_t seed = 1;
+        bool simd = true;      // false forces the scalar reference path
+    };
+
+    // Splits the volume into Z slabs across `pool` (a temporary pool when null).
+    // Throws std::runtime_error for an unsupported size.
+    static std::vector<unsigned char> Generate(const Settings& settings, ThreadPool* pool = nullptr);
+
+    // Single voxel through the scalar path; out receives RGBA8.
+    static void GenerateVoxel(const Settings& settings, uint32_t x, uint32_t y, uint32_t z, unsigned char out[4]);
+
+    // Tileable 2D curl of a Perlin FBM potential, size x size RGBA8 (RG = curl * 0.5 + 0.5).
+    static std::vector<unsigned char> GenerateCurl(uint32_t size, uint32_t seed, ThreadPool* pool = nullptr);
+
+    static bool HasSimd();
+    static const char* VolumeName(Volume volume);
+};
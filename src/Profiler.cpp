@@ -0,0 +1,192 @@
+#include "Profiler.hpp"
+
+#include <json.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    // Value at fraction q of the sorted samples (nearest rank).
+    float Percentile(std::vector<float>& sorted, double q) {
+        if (sorted.empty()) return 0.0f;
+        const size_t i = std::min(sorted.size() - 1, (size_t)(q * sorted.size()));
+        return sorted[i];
+    }
+
+    void PrintSummary(const char* clock, std::vector<float> values) {
+        if (values.empty()) {
+            std::fprintf(stderr, "  %s -\n", clock);
+            return;
+        }
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (float v : values) sum += v;
+        std::fprintf(stderr, "  %s min %7.3f  avg %7.3f  p95 %7.3f  p99 %7.3f ms\n",
+            clock, values.front(), sum / values.size(), Percentile(values, 0.95), Percentile(values, 0.99));
+    }
+}
+
+void Profiler::Samples::push(float ms) {
+    if (values.size() < kStatsWindow) {
+        values.push_back(ms);
+        return;
+    }
+    values[next] = ms;
+    next = (next + 1) % kStatsWindow;
+}
+
+Profiler::Profiler() {
+    epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::~Profiler() {
+    for (Frame& frame : frames) {
+        if (!frame.queries.empty()) glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+    }
+}
+
+int64_t Profiler::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() - epoch;
+}
+
+void Profiler::setEnabled(bool on) {
+    enabled = on;
+}
+
+void Profiler::beginFrame() {
+    // Zones left open by the previous frame are cut off here.
+    while (!openZones.empty()) endZone();
+
+    current = (current + 1) % kLatency;
+    Frame& frame = frames[current];
+    collect(frame);
+
+    frame.zones.clear();
+    frame.usedQueries = 0;
+    frame.recorded = enabled;
+    frame.index = frameIndex++;
+    if (!enabled) return;
+
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    frame.cpuSync = now();
+    frame.gpuSync = gpuNow;
+}
+
+void Profiler::beginZone(const char* name) {
+    Frame& frame = frames[current];
+    if (!frame.recorded) return;
+
+    if (frame.usedQueries + 2 > frame.queries.size()) {
+        const size_t grow = std::max<size_t>(16, frame.queries.size());
+        frame.queries.resize(frame.queries.size() + grow);
+        glGenQueries((GLsizei)grow, frame.queries.data() + frame.queries.size() - grow);
+    }
+
+    ZoneRecord zone{ name, (int)openZones.size(), now(), 0, frame.usedQueries };
+    frame.usedQueries += 2;
+    glQueryCounter(frame.queries[zone.gpuQuery], GL_TIMESTAMP);
+    frame.lastIssued = zone.gpuQuery;
+
+    openZones.push_back(frame.zones.size());
+    frame.zones.push_back(zone);
+}
+
+void Profiler::endZone() {
+    if (openZones.empty()) return;
+    Frame& frame = frames[current];
+    ZoneRecord& zone = frame.zones[openZones.back()];
+    openZones.pop_back();
+
+    glQueryCounter(frame.queries[zone.gpuQuery + 1], GL_TIMESTAMP);
+    frame.lastIssued = zone.gpuQuery + 1;
+    zone.cpuEnd = now();
+}
+
+void Profiler::collect(Frame& frame) {
+    if (!frame.recorded || frame.zones.empty()) return;
+
+    // Timestamps complete in submission order: the last one issued being available means
+    // all are. That is not the last query slot: an outer zone ends after its children.
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.lastIssued], GL_QUERY_RESULT_AVAILABLE, &available);
+
+    std::vector<TraceEvent> events;
+    events.reserve(frame.zones.size() * 2);
+    // Per-frame totals: a zone entered several times (e.g. "bind") counts once.
+    std::unordered_map<std::string_view, std::pair<double, double>> totals;
+
+    for (const ZoneRecord& zone : frame.zones) {
+        events.push_back({ zone.name, frame.index, zone.cpuBegin, zone.cpuEnd - zone.cpuBegin, false });
+        std::pair<double, double>& total = totals[zone.name];
+        total.first += (zone.cpuEnd - zone.cpuBegin) / 1e6;
+
+        if (!available) continue;
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[zone.gpuQuery], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[zone.gpuQuery + 1], GL_QUERY_RESULT, &end);
+        const int64_t start = (int64_t)begin - frame.gpuSync + frame.cpuSync;
+        events.push_back({ zone.name, frame.index, start, (int64_t)(end - begin), true });
+        total.second += (end - begin) / 1e6;
+    }
+
+    for (const ZoneRecord& zone : frame.zones) {
+        auto it = totals.find(zone.name);
+        if (it == totals.end()) continue;
+        auto inserted = stats.try_emplace(zone.name);
+        if (inserted.second) zoneOrder.push_back(zone.name);
+        inserted.first->second.cpu.push((float)it->second.first);
+        if (available) inserted.first->second.gpu.push((float)it->second.second);
+        totals.erase(it);
+    }
+
+    trace.push_back(std::move(events));
+    while (trace.size() > kTraceFrames) trace.pop_front();
+}
+
+void Profiler::printStats() const {
+    std::fprintf(stderr, "[profiler] last %zu frames per zone:\n", kStatsWindow);
+    for (const std::string& name : zoneOrder) {
+        const ZoneStats& zone = stats.at(name);
+        std::fprintf(stderr, " %s\n", name.c_str());
+        PrintSummary("cpu", zone.cpu.values);
+        PrintSummary("gpu", zone.gpu.values);
+    }
+}
+
+bool Profiler::writeTrace(const std::string& path) const {
+    using nlohmann::json;
+
+    json events = json::array();
+    const char* threads[] = { "CPU", "GPU" };
+    for (int tid = 0; tid < 2; ++tid) {
+        events.push_back({ { "name", "thread_name" }, { "ph", "M" }, { "pid", 1 }, { "tid", tid + 1 },
+            { "args", { { "name", threads[tid] } } } });
+    }
+
+    for (const std::vector<TraceEvent>& frame : trace) {
+        for (const TraceEvent& e : frame) {
+            events.push_back({
+                { "name", e.name },
+                { "cat", e.gpu ? "gpu" : "cpu" },
+                { "ph", "X" },
+                { "ts", e.begin / 1000.0 },
+                { "dur", e.duration / 1000.0 },
+                { "pid", 1 },
+                { "tid", e.gpu ? 2 : 1 },
+                { "args", { { "frame", e.frame } } },
+            });
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::fprintf(stderr, "[profiler] cannot write %s\n", path.c_str());
+        return false;
+    }
+    out << json{ { "traceEvents", std::move(events) }, { "displayTimeUnit", "ms" } }.dump();
+    std::fprintf(stderr, "[profiler] wrote %zu frames to %s\n", trace.size(), path.c_str());
+    return (bool)out;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Nested CPU + GPU timing zones. CPU times come from steady_clock; GPU times from
+// glQueryCounter(GL_TIMESTAMP) pairs kept in a ring of kLatency frames, read when their
+// slot comes round again and only if already available (never waiting on the GPU).
+// Finished frames feed rolling per-zone statistics and a Chrome trace (chrome://tracing,
+// Perfetto) of the last kTraceFrames frames.
+class Profiler {
+public:
+    static constexpr int kLatency = 4;
+    static constexpr size_t kStatsWindow = 600;
+    static constexpr size_t kTraceFrames = 300;
+
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+
+    // Collects the frame kLatency frames back and starts recording this one.
+    void beginFrame();
+    // Zones nest; each endZone() closes the innermost open one. Names must outlive the
+    // profiler (string literals).
+    void beginZone(const char* name);
+    void endZone();
+
+    // min / avg / p95 / p99 of every zone over the last kStatsWindow frames (ms).
+    void printStats() const;
+    bool writeTrace(const std::string& path) const;
+
+private:
+    struct ZoneRecord {
+        const char* name;
+        int depth;
+        int64_t cpuBegin;
+        int64_t cpuEnd;
+        size_t gpuQuery;  // begin; end is gpuQuery + 1
+    };
+
+    struct Frame {
+        std::vector<ZoneRecord> zones;
+        std::vector<GLuint> queries;
+        size_t usedQueries = 0;
+        size_t lastIssued = 0;  // query most recently stamped; outer zones end last
+        uint64_t index = 0;
+        // CPU and GPU clocks sampled together, to place GPU zones on the CPU timeline.
+        int64_t cpuSync = 0;
+        int64_t gpuSync = 0;
+        bool recorded = false;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        uint64_t frame;
+        int64_t begin;     // ns since the profiler was created
+        int64_t duration;  // ns
+        bool gpu;
+    };
+
+    // Fixed-size ring of per-frame totals (ms).
+    struct Samples {
+        std::vector<float> values;
+        size_t next = 0;
+
+        void push(float ms);
+    };
+
+    struct ZoneStats {
+        Samples cpu;
+        Samples gpu;
+    };
+
+    int64_t now() const;
+    void collect(Frame& frame);
+
+    bool enabled = true;
+    int64_t epoch = 0;
+    uint64_t frameIndex = 0;
+    Frame frames[kLatency];
+    int current = 0;
+    std::vector<size_t> openZones;
+
+    std::unordered_map<std::string, ZoneStats> stats;
+    std::vector<std::string> zoneOrder;  // first-seen order, for printing
+    std::deque<std::vector<TraceEvent>> trace;
+};
+
+// Scoped zone; does nothing with a null profiler.
+class ProfileZone {
+public:
+    ProfileZone(Profiler* profiler, const char* name) : profiler(profiler) {
+        if (profiler) profiler->beginZone(name);
+    }
+    ~ProfileZone() {
+        if (profiler) profiler->endZone();
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler* profiler;
+};
@@ -0,0 +1,138 @@
+#include "ProgramBinaryCache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr uint32_t kBinaryMagic = 0x4E494250; // "PBIN"
+
+    struct BinaryHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    uint64_t Fnv1a64(uint64_t hash, std::string_view data) {
+        for (char c : data) {
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string GetGLString(GLenum name) {
+        const GLubyte* s = glGetString(name);
+        return s ? reinterpret_cast<const char*>(s) : "";
+    }
+}
+
+ProgramBinaryCache::ProgramBinaryCache(std::filesystem::path dir) : directory(std::move(dir)) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        std::fprintf(stderr, "[ProgramBinaryCache] driver exposes no program binary formats, cache disabled\n");
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        std::fprintf(stderr, "[ProgramBinaryCache] cannot create %s: %s\n", directory.string().c_str(), ec.message().c_str());
+        return;
+    }
+
+    driverId = GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" + GetGLString(GL_VERSION);
+    enabled = true;
+}
+
+std::string ProgramBinaryCache::makeKey(const std::vector<std::string_view>& sources, std::string_view defines) const {
+    uint64_t hash = 14695981039346656037ull;
+    hash = Fnv1a64(hash, driverId);
+    hash = Fnv1a64(hash, std::string_view("\0", 1));
+    hash = Fnv1a64(hash, defines);
+    for (std::string_view src : sources) {
+        hash = Fnv1a64(hash, std::string_view("\0", 1));
+        hash = Fnv1a64(hash, src);
+    }
+
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+    return buf;
+}
+
+std::filesystem::path ProgramBinaryCache::pathFor(const std::string& key) const {
+    return directory / (key + ".bin");
+}
+
+bool ProgramBinaryCache::load(GLuint program, const std::string& key) {
+    if (!enabled) return false;
+
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file) {
+        misses++;
+        return false;
+    }
+
+    BinaryHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kBinaryMagic || header.length == 0) {
+        misses++;
+        return false;
+    }
+
+    std::vector<char> blob(header.length);
+    file.read(blob.data(), blob.size());
+    if (!file) {
+        misses++;
+        return false;
+    }
+
+    glProgramBinary(program, (GLenum)header.format, blob.data(), (GLsizei)blob.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        // Stale blob (driver changed in a way the key did not catch); drop it.
+        rejected++;
+        misses++;
+        std::error_code ec;
+        std::filesystem::remove(pathFor(key), ec);
+        return false;
+    }
+
+    hits++;
+    return true;
+}
+
+void ProgramBinaryCache::store(GLuint program, const std::string& key) {
+    if (!enabled) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> blob(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, blob.data());
+    if (written <= 0) return;
+
+    // Write to a temporary name first so a crash never leaves a truncated entry.
+    const std::filesystem::path target = pathFor(key);
+    std::filesystem::path tmp = target;
+    tmp += ".tmp";
+
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file) return;
+        BinaryHeader header{ kBinaryMagic, (uint32_t)format, (uint32_t)written };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(blob.data(), written);
+        if (!file) return;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, target, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+// Entries are keyed by a hash of the shader sources, the defines and the driver
+// vendor/renderer/version strings, so a driver update simply misses.
+class ProgramBinaryCache {
+public:
+    explicit ProgramBinaryCache(std::filesystem::path directory);
+
+    bool isEnabled() const { return enabled; }
+
+    std::string makeKey(const std::vector<std::string_view>& sources, std::string_view defines = {}) const;
+
+    // Restores `program` from the blob stored under `key`. Returns false when there is
+    // no entry or the driver rejects it; the caller then compiles from source.
+    bool load(GLuint program, const std::string& key);
+
+    // Stores a linked program. It must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+    void store(GLuint program, const std::string& key);
+
+    int getHits() const { return hits; }
+    int getMisses() const { return misses; }
+    int getRejected() const { return rejected; }
+
+private:
+    std::filesystem::path pathFor(const std::string& key) const;
+
+    std::filesystem::path directory;
+    std::string driverId;
+    bool enabled = false;
+
+    // programs may be restored on the GLLoader thread
+    std::atomic<int> hits{ 0 };
+    std::atomic<int> misses{ 0 };
+    std::atomic<int> rejected{ 0 };
+};
@@ -0,0 +1,110 @@
+#include "ResolutionGovernor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+ResolutionGovernor::ResolutionGovernor(double budget) {
+    setBudget(budget);
+    for (Frame& frame : frames) {
+        glCreateQueries(GL_TIME_ELAPSED, kMaxPasses, frame.queries);
+    }
+}
+
+ResolutionGovernor::~ResolutionGovernor() {
+    if (passOpen) glEndQuery(GL_TIME_ELAPSED);
+    for (Frame& frame : frames) {
+        glDeleteQueries(kMaxPasses, frame.queries);
+    }
+}
+
+void ResolutionGovernor::setEnabled(bool on) {
+    enabled = on;
+    smoothedMs = -1.0;
+}
+
+void ResolutionGovernor::setBudget(double ms) {
+    budgetMs = ms > 0.0 ? ms : 16.0;
+    smoothedMs = -1.0;
+}
+
+void ResolutionGovernor::beginFrame() {
+    if (passOpen) endPass();
+
+    current = (current + 1) % kLatency;
+    Frame& frame = frames[current];
+    collect(frame);
+    frame.count = 0;
+    frame.scale = getScale();
+}
+
+void ResolutionGovernor::beginPass(const char* name) {
+    Frame& frame = frames[current];
+    if (passOpen || frame.count == kMaxPasses) return;
+    frame.names[frame.count] = name;
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.count]);
+    passOpen = true;
+}
+
+void ResolutionGovernor::endPass() {
+    if (!passOpen) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    frames[current].count++;
+    passOpen = false;
+}
+
+void ResolutionGovernor::collect(Frame& frame) {
+    if (frame.count == 0) return;
+
+    // Queries complete in order: the last one available means all of them are.
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    double total = 0.0;
+    for (int i = 0; i < frame.count; ++i) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &ns);
+        lastPassMs[i] = ns / 1e6;
+        lastPassNames[i] = frame.names[i];
+        total += lastPassMs[i];
+    }
+    lastPassCount = frame.count;
+
+    adjust(total, frame.scale);
+}
+
+void ResolutionGovernor::adjust(double gpuMs, float measuredScale) {
+    // Frames from before the last change say nothing about the current scale.
+    if (measuredScale != getScale()) return;
+
+    smoothedMs = smoothedMs < 0.0 ? gpuMs : smoothedMs + (gpuMs - smoothedMs) * 0.2;
+    if (!enabled) return;
+
+    const bool over = smoothedMs > budgetMs * kHighWater;
+    const bool under = smoothedMs < budgetMs * kLowWater && scale < 1.0f;
+    if (!over && !under) return;
+
+    // Cost follows the pixel count; aim for the middle of the band.
+    const double target = budgetMs * (kHighWater + kLowWater) * 0.5;
+    float next = scale * (float)std::sqrt(target / std::max(smoothedMs, 0.01));
+    next = std::round(next / kScaleStep) * kScaleStep;
+    // Grow a step at a time: a too-large step up lands straight back over budget.
+    next = std::clamp(next, kMinScale, std::min(1.0f, scale + kScaleStep));
+    if (std::fabs(next - scale) < kScaleStep * 0.5f) return;
+
+    std::fprintf(stderr, "[resolution] %.0f%% -> %.0f%% (gpu %.1f ms, budget %.1f ms)\n",
+        scale * 100.0f, next * 100.0f, smoothedMs, budgetMs);
+    scale = next;
+    smoothedMs = -1.0;
+}
+
+void ResolutionGovernor::printLastFrame() const {
+    double total = 0.0;
+    for (int i = 0; i < lastPassCount; ++i) {
+        std::fprintf(stderr, "[resolution] %-8s %6.2f ms\n", lastPassNames[i], lastPassMs[i]);
+        total += lastPassMs[i];
+    }
+    std::fprintf(stderr, "[resolution] total %.2f ms, smoothed %.2f ms, budget %.1f ms, scale %.0f%%%s\n",
+        total, smoothedMs, budgetMs, getScale() * 100.0f, enabled ? "" : " (off)");
+}
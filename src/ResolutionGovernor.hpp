@@ -0,0 +1,86 @@
+#pragma once
+#include <GL/glew.h>
+
+#include <cstdint>
+
+// Dynamic resolution: times the frame's GPU passes with GL_TIME_ELAPSED queries and picks
+// the scale (per axis) of the internal render resolution that keeps their sum within the
+// frame budget. Results are read kLatency frames later and only if already available, so
+// measuring never stalls the pipeline. The scale moves in kScaleStep steps, only when the
+// smoothed time leaves the [kLowWater, kHighWater] band around the budget, and then waits
+// until frames rendered at the new scale have been measured.
+class ResolutionGovernor {
+public:
+    static constexpr int kLatency = 4;
+    static constexpr int kMaxPasses = 8;
+    static constexpr float kMinScale = 0.5f;
+    static constexpr float kScaleStep = 0.05f;
+    static constexpr double kHighWater = 1.0;
+    static constexpr double kLowWater = 0.75;
+
+    explicit ResolutionGovernor(double budgetMs);
+    ~ResolutionGovernor();
+
+    ResolutionGovernor(const ResolutionGovernor&) = delete;
+    ResolutionGovernor& operator=(const ResolutionGovernor&) = delete;
+
+    // Disabled: the scale stays at 1 (passes are still timed).
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled; }
+    void setBudget(double ms);
+    double getBudget() const { return budgetMs; }
+
+    // Collects the frame kLatency frames back and starts recording this one.
+    void beginFrame();
+    // Passes of one frame are timed in sequence; they must not nest.
+    void beginPass(const char* name);
+    void endPass();
+
+    float getScale() const { return enabled ? scale : 1.0f; }
+    // Smoothed GPU time of the measured frames; negative before the first result.
+    double getGpuMs() const { return smoothedMs; }
+
+    // Per-pass times of the newest measured frame.
+    void printLastFrame() const;
+
+private:
+    struct Frame {
+        GLuint queries[kMaxPasses] = {};
+        const char* names[kMaxPasses] = {};
+        float scale = 1.0f;
+        int count = 0;
+    };
+
+    void collect(Frame& frame);
+    void adjust(double gpuMs, float measuredScale);
+
+    Frame frames[kLatency];
+    int current = 0;
+    bool passOpen = false;
+
+    double lastPassMs[kMaxPasses] = {};
+    const char* lastPassNames[kMaxPasses] = {};
+    int lastPassCount = 0;
+
+    bool enabled = true;
+    double budgetMs = 16.0;
+    float scale = 1.0f;
+    double smoothedMs = -1.0;
+};
+
+// Times one pass for the governor; does nothing with a null governor.
+class GpuPassScope {
+public:
+    GpuPassScope(ResolutionGovernor* governor, const char* name) : governor(governor) {
+        if (governor) governor->beginPass(name);
+    }
+    ~GpuPassScope() {
+        if (governor) governor->endPass();
+    }
+
+    GpuPassScope(const GpuPassScope&) = delete;
+    GpuPassScope& operator=(const GpuPassScope&) = delete;
+
+private:
+    ResolutionGovernor* governor;
+};
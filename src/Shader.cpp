@@ -1,97 +1,66 @@
 #include "Shader.hpp"
-
-Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath) {
-    try {
-        if (geometryPath != nullptr) {
-            std::cout << "Geometry shader path: " << geometryPath << std::endl;
-        }
-
-        std::string vShaderCode = loadShaderFromFile(vertexPath);
-        std::string fShaderCode = loadShaderFromFile(fragmentPath);
-        std::string gShaderCode;
-
-        bool hasGeometryShader = (geometryPath != nullptr && strlen(geometryPath) > 0);
-        if (hasGeometryShader) {
-            gShaderCode = loadShaderFromFile(geometryPath);
-        }
-
-        const char* vShaderString = vShaderCode.c_str();
-        const char* fShaderString = fShaderCode.c_str();
-        const char* gShaderString = hasGeometryShader ? gShaderCode.c_str() : nullptr;
-
-        unsigned int vertex, fragment, geometry = 0;
-
-        std::cout << "Compiling vertex shader..." << std::endl;
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        if (vertex == 0) {
-            throw std::runtime_error("Failed to create vertex shader object");
+#include "GLState.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <regex>
+
+namespace {
+    const char* StageLabel(GLenum type) {
+        switch (type) {
+        case GL_VERTEX_SHADER: return "VERTEX";
+        case GL_FRAGMENT_SHADER: return "FRAGMENT";
+        case GL_GEOMETRY_SHADER: return "GEOMETRY";
+        case GL_COMPUTE_SHADER: return "COMPUTE";
+        default: return "UNKNOWN";
         }
+    }
 
-        glShaderSource(vertex, 1, &vShaderString, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX", getShaderName(vertexPath));
-
-        std::cout << "Compiling fragment shader..." << std::endl;
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        if (fragment == 0) {
-            glDeleteShader(vertex);
-            throw std::runtime_error("Failed to create fragment shader object");
+    GLbitfield StageBit(GLenum type) {
+        switch (type) {
+        case GL_VERTEX_SHADER: return GL_VERTEX_SHADER_BIT;
+        case GL_FRAGMENT_SHADER: return GL_FRAGMENT_SHADER_BIT;
+        case GL_GEOMETRY_SHADER: return GL_GEOMETRY_SHADER_BIT;
+        case GL_COMPUTE_SHADER: return GL_COMPUTE_SHADER_BIT;
+        default: return 0;
         }
+    }
+}
 
-        glShaderSource(fragment, 1, &fShaderString, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT", getShaderName(fragmentPath));
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath)
+    : Shader(vertexPath, fragmentPath, geometryPath, BuildMode::Immediate) {
+}
 
-        if (hasGeometryShader) {
-            std::cout << "Compiling geometry shader..." << std::endl;
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            if (geometry == 0) {
-                glDeleteShader(vertex);
-                glDeleteShader(fragment);
-                throw std::runtime_error("Failed to create geometry shader object");
-            }
+Shader::Shader(const char* vertexPath, const char* fragmentPath, BuildMode mode)
+    : Shader(vertexPath, fragmentPath, nullptr, mode) {
+}
 
-            glShaderSource(geometry, 1, &gShaderString, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY", getShaderName(geometryPath));
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, BuildMode mode) {
+    try {
+        if (geometryPath != nullptr) {
+            std::cout << "Geometry shader path: " << geometryPath << std::endl;
         }
 
-        std::cout << "Creating shader program..." << std::endl;
-        ID = glCreateProgram();
-        if (ID == 0) {
-            glDeleteShader(vertex);
-            glDeleteShader(fragment);
-            if (hasGeometryShader) glDeleteShader(geometry);
-            throw std::runtime_error("Failed to create shader program");
-        }
+        std::vector<StageSource> stages;
+        stages.push_back({ GL_VERTEX_SHADER, getShaderName(vertexPath), loadShaderFromFile(vertexPath) });
+        stages.push_back({ GL_FRAGMENT_SHADER, getShaderName(fragmentPath), loadShaderFromFile(fragmentPath) });
 
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
+        bool hasGeometryShader = (geometryPath != nullptr && strlen(geometryPath) > 0);
         if (hasGeometryShader) {
-            glAttachShader(ID, geometry);
+            stages.push_back({ GL_GEOMETRY_SHADER, getShaderName(geometryPath), loadShaderFromFile(geometryPath) });
         }
 
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM", "");
-
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+        std::string programName = getShaderName(vertexPath) + " AND " + getShaderName(fragmentPath);
         if (hasGeometryShader) {
-            glDeleteShader(geometry);
+            programName += " AND " + getShaderName(geometryPath);
         }
 
-        std::cout << "Shader program created successfully with ID: " << ID << std::endl;
-        if (hasGeometryShader) {
-            std::cout << "Geometry shader included!" << std::endl;
-        }
+        beginBuild(stages, programName);
 
-        std::string logMessage = "SHADERS " + getShaderName(vertexPath) + " AND " + getShaderName(fragmentPath);
-        if (hasGeometryShader) {
-            logMessage += " AND " + getShaderName(geometryPath);
+        if (mode == BuildMode::Immediate) {
+            finishBuild();
         }
-        logMessage += " LOADED AND COMPILED!";
-
-        std::cerr << logMessage << std::endl;
     }
     catch (const std::invalid_argument& e) {
         std::cerr << "std::invalid_argument in Shader constructor: " << e.what() << std::endl;
@@ -105,43 +74,172 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath, const char* geo
     }
 }
 
+Shader::Shader(GLenum stage, const char* path, BuildMode mode)
+    : Shader(stage, path, ShaderDefines{}, mode) {
+}
+
+Shader::Shader(GLenum stage, const char* path, const ShaderDefines& stageDefines, BuildMode mode)
+    : defines(stageDefines) {
+    try {
+        std::vector<StageSource> stages;
+        stages.push_back({ stage, getShaderName(path), loadShaderFromFile(path) });
+
+        separable = true;
+        beginBuild(stages, getShaderName(path));
+
+        if (mode == BuildMode::Immediate) {
+            finishBuild();
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Exception in separable Shader constructor: " << e.what() << std::endl;
+        throw;
+    }
+}
+
 Shader::Shader(const char* computePath) {
     try {
-        std::cout << "=== COMPUTE SHADER CREATION DEBUG ===" << std::endl;
         std::cout << "Compute shader path: " << computePath << std::endl;
 
-        std::string computeCode = loadShaderFromFile(computePath);
-        const char* computeString = computeCode.c_str();
+        std::vector<StageSource> stages;
+        stages.push_back({ GL_COMPUTE_SHADER, getShaderName(computePath), loadShaderFromFile(computePath) });
 
-        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
-        if (compute == 0) {
-            throw std::runtime_error("Failed to create compute shader object");
-        }
+        beginBuild(stages, getShaderName(computePath));
+        finishBuild();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Exception in Compute Shader constructor: " << e.what() << std::endl;
+        std::cerr << "Compute shader creation failed: " + std::string(e.what()) << std::endl;
+        throw;
+    }
+}
 
-        glShaderSource(compute, 1, &computeString, NULL);
-        glCompileShader(compute);
-        checkCompileErrors(compute, "COMPUTE", getShaderName(computePath));
+bool Shader::s_ParallelCompile = false;
 
-        //  
-        ID = glCreateProgram();
-        if (ID == 0) {
-            glDeleteShader(compute);
-            throw std::runtime_error("Failed to create compute shader program");
+bool Shader::enableParallelCompile() {
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        s_ParallelCompile = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        s_ParallelCompile = true;
+    }
+    else {
+        s_ParallelCompile = false;
+    }
+    return s_ParallelCompile;
+}
+
+void Shader::beginBuild(const std::vector<StageSource>& stages, const std::string& programName) {
+    buildName = programName;
+    buildError.clear();
+
+    std::vector<std::string_view> sources;
+    for (const StageSource& stage : stages) sources.push_back(stage.source);
+
+    stageBits = 0;
+    for (const StageSource& stage : stages) stageBits |= StageBit(stage.type);
+
+    if (s_BinaryCache && s_BinaryCache->isEnabled()) {
+        pendingCacheKey = s_BinaryCache->makeKey(sources, separable ? "separable" : "");
+        if (loadFromBinaryCache(pendingCacheKey)) {
+            pendingCacheKey.clear();
+            buildState = BuildState::Ready;
+            std::cout << "Shader program " << buildName << " restored from binary cache with ID: " << ID << std::endl;
+            return;
         }
+    }
 
-        glAttachShader(ID, compute);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM", getShaderName(computePath));
+    // Submit every stage and the link without querying any status: with
+    // GL_KHR_parallel_shader_compile the driver works on them in the background.
+    for (const StageSource& stage : stages) {
+        GLuint shader = glCreateShader(stage.type);
+        if (shader == 0) {
+            releasePendingShaders();
+            throw std::runtime_error(std::string("Failed to create ") + StageLabel(stage.type) + " shader object");
+        }
+        const char* src = stage.source.c_str();
+        glShaderSource(shader, 1, &src, NULL);
+        glCompileShader(shader);
+        pendingShaders.push_back({ shader, stage.type, stage.name });
+    }
 
-        glDeleteShader(compute);
+    ID = glCreateProgram();
+    if (ID == 0) {
+        releasePendingShaders();
+        throw std::runtime_error("Failed to create shader program");
+    }
+
+    for (const PendingShader& p : pendingShaders) {
+        glAttachShader(ID, p.shader);
+    }
 
-        std::cout << "Compute shader program created successfully with ID: " << ID << std::endl;
+    if (separable) {
+        glProgramParameteri(ID, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+    if (!pendingCacheKey.empty()) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    glLinkProgram(ID);
+    buildState = BuildState::Compiling;
+}
+
+void Shader::finishBuild() {
+    try {
+        for (const PendingShader& p : pendingShaders) {
+            checkCompileErrors(p.shader, StageLabel(p.type), p.name);
+        }
+        checkCompileErrors(ID, "PROGRAM", buildName);
     }
     catch (const std::exception& e) {
-        std::cerr << "Exception in Compute Shader constructor: " << e.what() << std::endl;
-        std::cerr << "Compute shader creation failed: " + std::string(e.what()) << std::endl;
+        releasePendingShaders();
+        glDeleteProgram(ID);
+        ID = 0;
+        pendingCacheKey.clear();
+        buildError = e.what();
+        buildState = BuildState::Failed;
         throw;
     }
+
+    releasePendingShaders();
+    cacheUniforms();
+    bindUniformBlocks();
+
+    if (!pendingCacheKey.empty()) {
+        s_BinaryCache->store(ID, pendingCacheKey);
+        pendingCacheKey.clear();
+    }
+
+    buildState = BuildState::Ready;
+    std::cerr << "SHADERS " << buildName << " LOADED AND COMPILED! (ID " << ID << ")" << std::endl;
+}
+
+bool Shader::poll() {
+    if (buildState != BuildState::Compiling) return true;
+
+    if (s_ParallelCompile) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
+    }
+
+    try {
+        finishBuild();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Shader build failed (" << buildName << "): " << e.what() << std::endl;
+    }
+    return true;
+}
+
+void Shader::releasePendingShaders() {
+    for (const PendingShader& p : pendingShaders) {
+        if (ID != 0) glDetachShader(ID, p.shader);
+        glDeleteShader(p.shader);
+    }
+    pendingShaders.clear();
 }
 
 void Shader::dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) const {
@@ -149,84 +247,132 @@ void Shader::dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint nu
         std::cerr << "Cannot dispatch compute shader: invalid program ID" << std::endl;
         return;
     }
-    glUseProgram(ID);
+    GLState::get().useProgram(ID);
     glDispatchCompute(num_groups_x, num_groups_y, num_groups_z);
     //     (  LBVH)
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
+ProgramBinaryCache* Shader::s_BinaryCache = nullptr;
+
+void Shader::setBinaryCache(ProgramBinaryCache* cache) {
+    s_BinaryCache = cache;
+}
+
+bool Shader::loadFromBinaryCache(const std::string& cacheKey) {
+    GLuint program = glCreateProgram();
+    if (program == 0) return false;
+
+    if (separable) {
+        glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+
+    if (!s_BinaryCache->load(program, cacheKey)) {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    ID = program;
+    buildState = BuildState::Ready;
+    cacheUniforms();
+    bindUniformBlocks();
+    return true;
+}
+
+void Shader::setVertexStage(const Shader& vertexStage) {
+    if (!separable || !vertexStage.separable || !isReady() || !vertexStage.isReady()) {
+        throw std::logic_error("setVertexStage needs two linked separable programs");
+    }
+
+    if (pipeline == 0) {
+        glGenProgramPipelines(1, &pipeline);
+    }
+    glUseProgramStages(pipeline, GL_ALL_SHADER_BITS, 0);
+    glUseProgramStages(pipeline, vertexStage.stageBits, vertexStage.ID);
+    glUseProgramStages(pipeline, stageBits, ID);
+    pipelineVertexStage = vertexStage.ID;
+}
+
 Shader::~Shader() {
+    if (pipeline != 0) {
+        glDeleteProgramPipelines(1, &pipeline);
+        GLState::get().pipelineDeleted(pipeline);
+        pipeline = 0;
+    }
+    releasePendingShaders();
     if (ID != 0) {
         glDeleteProgram(ID);
+        GLState::get().programDeleted(ID);
         ID = 0;
     }
     std::cerr << "Shader program deleted." << std::endl;
 }
 
 void Shader::use() const {
-    glUseProgram(ID);
+    GLState& gl = GLState::get();
+    if (pipeline != 0) {
+        // A bound program would take precedence over the pipeline.
+        gl.useProgram(0);
+        gl.bindProgramPipeline(pipeline);
+    }
+    else {
+        gl.useProgram(ID);
+    }
     m_ProgramInUse = ID;
 }
 
 void Shader::setBool(const std::string& name, bool value) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
-    glUniform1i(location, (int)value);
+    GLint location = getUniformLocation(name);
+    if (location != -1) glProgramUniform1i(ID, location, (int)value);
 }
 
 void Shader::setInt(const std::string& name, int value) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         std::cerr << "Failed to find uniform: " + name << std::endl;
         return;
     }
-    glUniform1i(location, value);
+    glProgramUniform1i(ID, location, value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         std::cerr << "Failed to find uniform: " + name << std::endl;
         return;
     }
-    glUniform1f(location, value);
+    glProgramUniform1f(ID, location, value);
 }
 
 void Shader::setVec2(const std::string& name, glm::vec2 vector) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         std::cerr << "Failed to find uniform: " + name << std::endl;
         return;
     }
-    glUniform2fv(location, 1, glm::value_ptr(vector));
+    glProgramUniform2fv(ID, location, 1, glm::value_ptr(vector));
 }
 
 void Shader::setVec3(const std::string& name, glm::vec3 vector) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         std::cerr << "Failed to find uniform: " + name << std::endl;
         return;
     }
-    glUniform3fv(location, 1, glm::value_ptr(vector));
+    glProgramUniform3fv(ID, location, 1, glm::value_ptr(vector));
 }
 
 void Shader::setVec4(const std::string& name, glm::vec4 vector) const {
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         std::cerr << "Failed to find uniform: " + name << std::endl;
         return;
     }
-    glUniform4fv(location, 1, glm::value_ptr(vector));
+    glProgramUniform4fv(ID, location, 1, glm::value_ptr(vector));
 }
 
 void Shader::setMat4(const std::string& name, glm::mat4 matrix) const {
-    GLint currentProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-
-    if (currentProgram != (GLint)ID) {
-        return;
-    }
-
-    GLint location = glGetUniformLocation(ID, name.c_str());
+    GLint location = getUniformLocation(name);
     if (location == -1) {
         static std::set<std::string> reportedUniforms;
         std::string key = std::to_string(ID) + "_" + name;
@@ -235,18 +381,16 @@ void Shader::setMat4(const std::string& name, glm::mat4 matrix) const {
         }
         return;
     }
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+    glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::setSampler2D(const std::string& name, unsigned int texture, int id) const {
-    glActiveTexture(GL_TEXTURE0 + id);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    GLState::get().bindTexture(id, texture);
     this->setInt(name, id);
 }
 
 void Shader::setSampler3D(const std::string& name, unsigned int texture, int id) const {
-    glActiveTexture(GL_TEXTURE0 + id);
-    glBindTexture(GL_TEXTURE_3D, texture);
+    GLState::get().bindTexture(id, texture);
     this->setInt(name, id);
 }
 
@@ -260,9 +404,9 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type, std::stri
             std::ostringstream logMessage;
             logMessage << "ERROR: SHADER " << shaderName
                 << " COMPILATION ERROR of type: " << type
-                << "\n" << infoLog
+                << "\n" << remapSourceNames(infoLog)
                 << "\n-------------------------------------------------------";
-            throw std::runtime_error("Shader compilation failed: " + type + " " + shaderName);
+            throw std::runtime_error(logMessage.str());
         }
     }
     else {
@@ -274,54 +418,186 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type, std::stri
                 << " of type: " << type
                 << "\n" << infoLog
                 << "\n-------------------------------------------------------";
-            throw std::runtime_error("Shader program linking failed");
+            throw std::runtime_error(logMessage.str());
         }
     }
 }
 
-std::string Shader::loadShaderFromFile(const char* shaderPath) {
-    std::string shaderCode;
-    std::ifstream shaderFile;
+namespace {
+    struct CachedSource {
+        std::filesystem::file_time_type writeTime;
+        std::string text;
+    };
 
-    std::cout << "Attempting to load shader: " << shaderPath << std::endl;
+    // Guards the source cache: programs are also built on the GLLoader thread.
+    std::mutex& SourceMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
 
-    std::ifstream testFile(shaderPath);
-    if (!testFile.good()) {
-        std::string error = "Shader file does not exist or cannot be accessed: " + std::string(shaderPath);
-        throw std::invalid_argument(error);
+    std::unordered_map<std::string, CachedSource>& SourceCache() {
+        static std::unordered_map<std::string, CachedSource> cache;
+        return cache;
     }
-    testFile.close();
 
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+    constexpr int kMaxIncludeDepth = 32;
 
-    try {
-        shaderFile.open(shaderPath);
+    // Returns the quoted or bracketed file name of an #include line, or false if the line is not one.
+    bool ParseInclude(const std::string& line, std::string& target) {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#') return false;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) return false;
+        pos = line.find_first_of("\"<", pos + 7);
+        if (pos == std::string::npos) return false;
+        size_t end = line.find(line[pos] == '"' ? '"' : '>', pos + 1);
+        if (end == std::string::npos) return false;
+        target = line.substr(pos + 1, end - pos - 1);
+        return true;
+    }
 
-        if (!shaderFile.is_open()) {
-            throw std::runtime_error("Failed to open shader file: " + std::string(shaderPath));
-        }
+    bool IsDirective(const std::string& line, const char* name) {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#') return false;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        return pos != std::string::npos && line.compare(pos, strlen(name), name) == 0;
+    }
+}
+
+std::string Shader::definesKey(const ShaderDefines& defines) {
+    ShaderDefines sorted = defines;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string key;
+    for (const auto& define : sorted) {
+        key += define.first + "=" + define.second + ";";
+    }
+    return key;
+}
+
+void Shader::clearSourceCache() {
+    std::lock_guard<std::mutex> lock(SourceMutex());
+    SourceCache().clear();
+}
 
-        std::stringstream shaderStream;
-        shaderStream << shaderFile.rdbuf();
-        shaderFile.close();
-        shaderCode = shaderStream.str();
+int Shader::sourceFileIndex(const std::string& path) {
+    auto it = std::find(sourceFiles.begin(), sourceFiles.end(), path);
+    if (it != sourceFiles.end()) return (int)(it - sourceFiles.begin()) + 1;
+    sourceFiles.push_back(path);
+    return (int)sourceFiles.size();
+}
 
-        if (shaderCode.empty()) {
-            throw std::runtime_error("Shader file is empty: " + std::string(shaderPath));
+std::string Shader::remapSourceNames(const std::string& log) const {
+    // Drivers prefix messages with "<string>:<line>" (Mesa, AMD) or "<string>(<line>)" (NVIDIA).
+    static const std::regex location(R"((^|[^0-9.])([0-9]+)([:(])([0-9]+))");
+
+    std::istringstream in(log);
+    std::ostringstream out;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::smatch m;
+        if (std::regex_search(line, m, location)) {
+            int index = std::stoi(m[2].str());
+            if (index > 0 && index <= (int)sourceFiles.size()) {
+                line = m.prefix().str() + m[1].str() + sourceFiles[index - 1] + m[3].str() + m[4].str() + m.suffix().str();
+            }
         }
+        out << line << '\n';
+    }
+    return out.str();
+}
+
+std::string Shader::readSourceFile(const std::filesystem::path& path) {
+    std::error_code ec;
+    auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        throw std::invalid_argument("Shader file does not exist or cannot be accessed: " + path.string());
+    }
 
-        std::cout << "Successfully loaded shader: " << shaderPath << " (size: " << shaderCode.length() << " bytes)" << std::endl;
+    std::lock_guard<std::mutex> lock(SourceMutex());
+    auto& cache = SourceCache();
+    auto it = cache.find(path.string());
+    if (it != cache.end() && it->second.writeTime == writeTime) {
+        return it->second.text;
+    }
 
+    std::ifstream shaderFile(path, std::ios::binary);
+    if (!shaderFile.is_open()) {
+        throw std::runtime_error("Failed to open shader file: " + path.string());
     }
-    catch (const std::ifstream::failure& e) {
-        std::string error = "std::ifstream::failure when reading shader " + std::string(shaderPath) + ": " + e.what();
-        throw std::invalid_argument(error);
+    std::stringstream shaderStream;
+    shaderStream << shaderFile.rdbuf();
+    std::string text = shaderStream.str();
+    if (text.empty()) {
+        throw std::runtime_error("Shader file is empty: " + path.string());
     }
-    catch (const std::exception& e) {
-        std::string error = "Exception when reading shader " + std::string(shaderPath) + ": " + e.what();
-        throw;
+
+    cache[path.string()] = { writeTime, text };
+    return text;
+}
+
+std::string Shader::preprocessSource(const std::filesystem::path& path, std::vector<std::string>& included, int depth) {
+    if (depth > kMaxIncludeDepth) {
+        throw std::runtime_error("Shader #include nesting too deep at " + path.string());
+    }
+
+    std::string name = path.lexically_normal().generic_string();
+    included.push_back(name);
+    int fileIndex = sourceFileIndex(name);
+
+    std::istringstream in(readSourceFile(path));
+    std::ostringstream out;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        std::string target;
+        if (IsDirective(line, "version")) {
+            // Only the stage's own #version survives; numbering restarts right after it.
+            if (depth == 0) {
+                out << line << '\n';
+                for (const auto& define : defines) {
+                    out << "#define " << define.first << ' ' << define.second << '\n';
+                }
+                out << "#line " << lineNumber + 1 << ' ' << fileIndex << '\n';
+            }
+            else out << '\n';
+        }
+        else if (IsDirective(line, "pragma once")) {
+            out << '\n';
+        }
+        else if (ParseInclude(line, target)) {
+            std::filesystem::path includePath = (path.parent_path() / target).lexically_normal();
+            if (std::find(included.begin(), included.end(), includePath.generic_string()) != included.end()) {
+                out << '\n';
+                continue;
+            }
+            try {
+                out << "#line 1 " << sourceFileIndex(includePath.generic_string()) << '\n'
+                    << preprocessSource(includePath, included, depth + 1)
+                    << "#line " << lineNumber + 1 << ' ' << fileIndex << '\n';
+            }
+            catch (const std::invalid_argument& e) {
+                throw std::runtime_error(std::string(e.what()) + " (included from " + name + ":" + std::to_string(lineNumber) + ")");
+            }
+        }
+        else {
+            out << line << '\n';
+        }
     }
+    return out.str();
+}
+
+std::string Shader::loadShaderFromFile(const char* shaderPath) {
+    std::cout << "Attempting to load shader: " << shaderPath << std::endl;
+
+    std::vector<std::string> included;
+    std::string shaderCode = preprocessSource(shaderPath, included, 0);
 
+    std::cout << "Successfully loaded shader: " << shaderPath << " (size: " << shaderCode.length() << " bytes, "
+        << included.size() << " file(s))" << std::endl;
     return shaderCode;
 }
 
@@ -365,6 +641,8 @@ bool Shader::createFromString(const char* vertexSource, const char* fragmentSour
 
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM", "string");
+        cacheUniforms();
+        bindUniformBlocks();
 
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -447,14 +725,102 @@ void Shader::setProjection(const glm::mat4 a_Projection) {
     }
 }
 
-void Shader::debugUniforms() const {
+void Shader::cacheUniforms() {
+    uniformCache.clear();
+    if (ID == 0) return;
+
     GLint numUniforms = 0;
     glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &numUniforms);
 
+    auto insert = [&](const std::string& name, const UniformInfo& info) {
+        const uint32_t hash = HashUniformName(name);
+        auto it = uniformCache.find(hash);
+        if (it != uniformCache.end() && it->second.name != name) {
+            std::cerr << "Uniform name hash collision: " << name << " vs " << it->second.name << std::endl;
+            return;
+        }
+        uniformCache[hash] = info;
+    };
+
     for (GLint i = 0; i < numUniforms; i++) {
-        GLint size;
-        GLenum type;
+        GLint size = 0;
+        GLenum type = 0;
+        GLsizei length = 0;
         GLchar uniformName[256];
-        glGetActiveUniform(ID, i, sizeof(uniformName), nullptr, &size, &type, uniformName);
+        glGetActiveUniform(ID, i, sizeof(uniformName), &length, &size, &type, uniformName);
+
+        UniformInfo info;
+        info.name.assign(uniformName, length);
+        info.location = glGetUniformLocation(ID, uniformName);
+        info.type = type;
+        info.size = size;
+
+        // Members of uniform blocks have no location.
+        if (info.location == -1) continue;
+
+        insert(info.name, info);
+
+        // Arrays are reported as "name[0]"; make the bare name resolvable as well.
+        const size_t bracket = info.name.find('[');
+        if (bracket != std::string::npos) {
+            UniformInfo base = info;
+            base.name = info.name.substr(0, bracket);
+            insert(base.name, base);
+        }
+    }
+}
+
+std::unordered_map<std::string, GLuint>& Shader::uniformBlockBindings() {
+    static std::unordered_map<std::string, GLuint> bindings;
+    return bindings;
+}
+
+void Shader::setUniformBlockBinding(const std::string& blockName, GLuint binding) {
+    uniformBlockBindings()[blockName] = binding;
+}
+
+void Shader::bindUniformBlocks() {
+    if (ID == 0) return;
+
+    GLint numBlocks = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &numBlocks);
+
+    const auto& bindings = uniformBlockBindings();
+    for (GLint i = 0; i < numBlocks; i++) {
+        GLsizei length = 0;
+        GLchar blockName[256];
+        glGetActiveUniformBlockName(ID, (GLuint)i, sizeof(blockName), &length, blockName);
+
+        auto it = bindings.find(std::string(blockName, length));
+        if (it != bindings.end()) {
+            glUniformBlockBinding(ID, (GLuint)i, it->second);
+        }
+    }
+}
+
+GLint Shader::getUniformLocation(uint32_t nameHash) const {
+    auto it = uniformCache.find(nameHash);
+    return it != uniformCache.end() ? it->second.location : -1;
+}
+
+GLint Shader::getUniformLocation(std::string_view name) const {
+    auto it = uniformCache.find(HashUniformName(name));
+    if (it == uniformCache.end() || it->second.name != name) return -1;
+    return it->second.location;
+}
+
+GLint Shader::getUniformLocationAny(std::initializer_list<std::string_view> names) const {
+    for (std::string_view n : names) {
+        GLint loc = getUniformLocation(n);
+        if (loc != -1) return loc;
+    }
+    return -1;
+}
+
+void Shader::debugUniforms() const {
+    for (const auto& entry : uniformCache) {
+        const UniformInfo& u = entry.second;
+        std::cout << "uniform " << u.name << " location=" << u.location
+            << " type=0x" << std::hex << u.type << std::dec << " size=" << u.size << std::endl;
     }
 }
\ No newline at end of file
@@ -4,18 +4,86 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GLFW/glfw3.h>
 #include <string>
+#include <string_view>
 #include <set>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+#include <initializer_list>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "ProgramBinaryCache.hpp"
+
 static GLuint m_ProgramInUse = 0;
 
+// FNV-1a over the uniform name. constexpr so literal names can be hashed at compile time.
+constexpr uint32_t HashUniformName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Preprocessor defines injected after #version; each distinct set builds its own program.
+using ShaderDefines = std::vector<std::pair<std::string, std::string>>;
+
+struct UniformInfo {
+    GLint location = -1;
+    GLenum type = 0;
+    GLint size = 0;
+    std::string name;
+};
+
+inline void UploadUniform(GLuint program, GLint location, bool value) { glProgramUniform1i(program, location, (int)value); }
+inline void UploadUniform(GLuint program, GLint location, int value) { glProgramUniform1i(program, location, value); }
+inline void UploadUniform(GLuint program, GLint location, unsigned int value) { glProgramUniform1ui(program, location, value); }
+inline void UploadUniform(GLuint program, GLint location, float value) { glProgramUniform1f(program, location, value); }
+inline void UploadUniform(GLuint program, GLint location, const glm::vec2& value) { glProgramUniform2fv(program, location, 1, glm::value_ptr(value)); }
+inline void UploadUniform(GLuint program, GLint location, const glm::vec3& value) { glProgramUniform3fv(program, location, 1, glm::value_ptr(value)); }
+inline void UploadUniform(GLuint program, GLint location, const glm::vec4& value) { glProgramUniform4fv(program, location, 1, glm::value_ptr(value)); }
+inline void UploadUniform(GLuint program, GLint location, const glm::mat4& value) { glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value)); }
+
+// Location resolved once; set() is a single glProgramUniform* call and needs no bound program.
+template <typename T>
+class Uniform {
+public:
+    Uniform() = default;
+    Uniform(GLuint program, GLint location) : program(program), location(location) {}
+
+    bool valid() const { return location != -1; }
+    GLint getLocation() const { return location; }
+
+    void set(const T& value) const {
+        if (location != -1) UploadUniform(program, location, value);
+    }
+
+private:
+    GLuint program = 0;
+    GLint location = -1;
+};
+
 class Shader {
 public:
+    // Immediate builds block until linked and throw on errors. Deferred builds only
+    // submit compile + link; poll() finishes them once the driver is done.
+    enum class BuildMode { Immediate, Deferred };
+    enum class BuildState { Empty, Compiling, Ready, Failed };
+
     Shader() : ID(0) {}
 
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    Shader(const char* vertexPath, const char* fragmentPath, BuildMode mode);
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath, BuildMode mode);
+    // Single-stage separable program (GL_PROGRAM_SEPARABLE), combined with other stages
+    // through a program pipeline instead of being linked into every program.
+    Shader(GLenum stage, const char* path, BuildMode mode = BuildMode::Immediate);
+    Shader(GLenum stage, const char* path, const ShaderDefines& defines, BuildMode mode = BuildMode::Immediate);
     Shader(const char* computePath);
 
     virtual ~Shader();
@@ -52,18 +120,119 @@ public:
     static void setProjection(const glm::mat4 a_Projection);
 
 
+    GLint getUniformLocation(std::string_view name) const;
+    GLint getUniformLocation(uint32_t nameHash) const;
+    GLint getUniformLocationAny(std::initializer_list<std::string_view> names) const;
+
+    template <typename T>
+    Uniform<T> uniform(std::string_view name) const { return Uniform<T>(ID, getUniformLocation(name)); }
+
+    template <typename T>
+    Uniform<T> uniformAny(std::initializer_list<std::string_view> names) const { return Uniform<T>(ID, getUniformLocationAny(names)); }
+
+    const std::unordered_map<uint32_t, UniformInfo>& getUniforms() const { return uniformCache; }
+
+    // Programs created afterwards are restored from / stored into this cache. May be null.
+    static void setBinaryCache(ProgramBinaryCache* cache);
+
+    // Programs linked afterwards that declare the named uniform block get it bound to `binding`.
+    static void setUniformBlockBinding(const std::string& blockName, GLuint binding);
+
     void debugUniforms() const;
     void dispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) const;
     bool isCompiled() const {
         return ID != 0;
     }
 
+    // Returns true once the build has finished (ready or failed). Never blocks when
+    // parallel compilation is available; otherwise the first call waits for the link.
+    bool poll();
+    bool isReady() const { return buildState == BuildState::Ready; }
+    bool hasFailed() const { return buildState == BuildState::Failed; }
+    BuildState getBuildState() const { return buildState; }
+    const std::string& getBuildError() const { return buildError; }
+
+    // Separable fragment programs: builds (or rebuilds) the pipeline that pairs this
+    // program with the given separable vertex program. use() then binds the pipeline.
+    void setVertexStage(const Shader& vertexStage);
+    bool isSeparable() const { return separable; }
+    bool hasPipeline() const { return pipeline != 0; }
+    GLuint getPipelineVertexStage() const { return pipelineVertexStage; }
+
+    // Lets the driver compile on its own threads (KHR/ARB_parallel_shader_compile).
+    static bool enableParallelCompile();
+    static bool hasParallelCompile() { return s_ParallelCompile; }
+
+    const ShaderDefines& getDefines() const { return defines; }
+    // Stable "NAME=VALUE;..." string, used to key variants of one source.
+    static std::string definesKey(const ShaderDefines& defines);
+
+    // Every file read to build this program: the stage sources and everything they #include.
+    const std::vector<std::string>& getSourceFiles() const { return sourceFiles; }
+
+    // Shader sources are cached in memory and only re-read when their mtime changes.
+    static void clearSourceCache();
+
 protected:
     virtual void checkCompileErrors(unsigned int shader, std::string type, std::string shaderName);
     virtual std::string getShaderName(const char* shaderPath);
     virtual std::string loadShaderFromFile(const char* shaderPath);
 
+    // Expands #include "file" (resolved relative to the including file). A file is pasted
+    // at most once per stage, and #line directives keep compiler messages pointing at the
+    // original file and line.
+    std::string preprocessSource(const std::filesystem::path& path, std::vector<std::string>& included, int depth);
+    static std::string readSourceFile(const std::filesystem::path& path);
+    // #line source-string number of a file within this program: its position in
+    // sourceFiles + 1, so the preprocessed text (and the binary cache key) does not
+    // depend on what other programs were built before.
+    int sourceFileIndex(const std::string& path);
+    std::string remapSourceNames(const std::string& log) const;
+
     virtual bool createFromString(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr);
 
     virtual bool createFromString(const char* vertexSource, const char* fragmentSource);
+
+    // Called after every successful link: resolves all active uniforms once.
+    void cacheUniforms();
+    void bindUniformBlocks();
+
+    static std::unordered_map<std::string, GLuint>& uniformBlockBindings();
+
+    bool loadFromBinaryCache(const std::string& cacheKey);
+
+    struct StageSource {
+        GLenum type;
+        std::string name;
+        std::string source;
+    };
+
+    struct PendingShader {
+        GLuint shader;
+        GLenum type;
+        std::string name;
+    };
+
+    void beginBuild(const std::vector<StageSource>& stages, const std::string& programName);
+    void finishBuild();
+    void releasePendingShaders();
+
+    bool separable = false;
+    GLbitfield stageBits = 0;
+    GLuint pipeline = 0;
+    GLuint pipelineVertexStage = 0;
+
+    BuildState buildState = BuildState::Empty;
+    std::vector<PendingShader> pendingShaders;
+    std::string pendingCacheKey;
+    std::string buildName;
+    std::string buildError;
+    std::vector<std::string> sourceFiles;
+    ShaderDefines defines;
+
+    static ProgramBinaryCache* s_BinaryCache;
+    static bool s_ParallelCompile;
+
+private:
+    std::unordered_map<uint32_t, UniformInfo> uniformCache;
 };
\ No newline at end of file
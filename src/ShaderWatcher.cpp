@@ -0,0 +1,150 @@
+#include "ShaderWatcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr int kWakeIntervalMs = 250;
+    constexpr auto kPollInterval = std::chrono::milliseconds(500);
+}
+
+ShaderWatcher::ShaderWatcher(std::vector<std::filesystem::path> watchRoots) : roots(std::move(watchRoots)) {
+#ifdef __linux__
+    native = true;
+#endif
+    thread = std::thread(&ShaderWatcher::run, this);
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    running = false;
+    if (thread.joinable()) thread.join();
+}
+
+bool ShaderWatcher::isShaderFile(const std::filesystem::path& path) {
+    const std::string ext = path.extension().string();
+    return ext == ".glsl" || ext == ".vert" || ext == ".frag" || ext == ".geom" || ext == ".comp";
+}
+
+std::vector<ShaderWatcher::Change> ShaderWatcher::takeChanges() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Change> changes;
+    changes.swap(pending);
+    return changes;
+}
+
+void ShaderWatcher::push(const std::filesystem::path& root, const std::filesystem::path& file) {
+    if (!isShaderFile(file)) return;
+
+    Change change{ root, file.lexically_relative(root).generic_string() };
+
+    // Editors often produce several events per save; keep one entry per file.
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Change& c : pending) {
+        if (c.root == change.root && c.relativePath == change.relativePath) return;
+    }
+    pending.push_back(std::move(change));
+}
+
+void ShaderWatcher::run() {
+    if (native && runInotify()) return;
+
+    native = false;
+    runPolling();
+}
+
+bool ShaderWatcher::runInotify() {
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::perror("[hot reload] inotify_init1");
+        return false;
+    }
+
+    struct WatchedDir {
+        std::filesystem::path root;
+        std::filesystem::path dir;
+    };
+    std::unordered_map<int, WatchedDir> watches;
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    auto addWatch = [&](const std::filesystem::path& root, const std::filesystem::path& dir) {
+        int wd = inotify_add_watch(fd, dir.c_str(), mask);
+        if (wd >= 0) watches[wd] = { root, dir };
+        };
+
+    for (const auto& root : roots) {
+        std::error_code ec;
+        addWatch(root, root);
+        for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+            !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_directory(ec)) addWatch(root, it->path());
+        }
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while (running) {
+        pollfd pfd{ fd, POLLIN, 0 };
+        if (poll(&pfd, 1, kWakeIntervalMs) <= 0) continue;
+
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        for (ssize_t offset = 0; offset < len;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto it = watches.find(event->wd);
+            if (it == watches.end() || event->len == 0) continue;
+
+            const WatchedDir watched = it->second;
+            const std::filesystem::path path = watched.dir / event->name;
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) addWatch(watched.root, path);
+            }
+            else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                push(watched.root, path);
+            }
+        }
+    }
+
+    close(fd);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ShaderWatcher::runPolling() {
+    std::unordered_map<std::string, std::filesystem::file_time_type> seen;
+
+    auto scan = [&](bool report) {
+        for (const auto& root : roots) {
+            std::error_code ec;
+            for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+                !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (!it->is_regular_file(ec) || !isShaderFile(it->path())) continue;
+
+                auto writeTime = it->last_write_time(ec);
+                if (ec) continue;
+
+                auto& known = seen[it->path().string()];
+                if (report && known != writeTime) push(root, it->path());
+                known = writeTime;
+            }
+        }
+        };
+
+    scan(false);
+    while (running) {
+        auto wake = std::chrono::steady_clock::now() + kPollInterval;
+        while (running && std::chrono::steady_clock::now() < wake) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kWakeIntervalMs));
+        }
+        if (running) scan(true);
+    }
+}
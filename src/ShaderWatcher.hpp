@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Watches shader directories on a background thread (inotify on Linux, mtime polling
+// elsewhere) and queues every changed shader file. The render thread drains the queue
+// with takeChanges(); nothing here touches GL.
+class ShaderWatcher {
+public:
+    struct Change {
+        std::filesystem::path root;  // watched directory the file lives in
+        std::string relativePath;    // generic path below root, e.g. "include/common.glsl"
+    };
+
+    explicit ShaderWatcher(std::vector<std::filesystem::path> roots);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // Changes since the last call, one entry per file.
+    std::vector<Change> takeChanges();
+
+    const std::vector<std::filesystem::path>& getRoots() const { return roots; }
+    bool isNative() const { return native; }
+
+    static bool isShaderFile(const std::filesystem::path& path);
+
+private:
+    void run();
+    bool runInotify();
+    void runPolling();
+    void push(const std::filesystem::path& root, const std::filesystem::path& file);
+
+    std::vector<std::filesystem::path> roots;
+    std::atomic<bool> running{ true };
+    std::atomic<bool> native{ false };
+
+    std::mutex mutex;
+    std::vector<Change> pending;
+
+    std::thread thread;
+};
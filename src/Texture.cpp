@@ -1,89 +1,467 @@
 #include "Texture.hpp"
+#include "GLState.hpp"
+#include "BlockCompression.hpp"
 
-bool Texture::LoadTexture() {
-	unsigned char* texData = stbi_load(this->fileLocation, &this->width, &this->height, &this->bitDepht, 0);
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
-    if (!texData) {
-        printf("Failed Loading the file texture\n");
-        return false;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    struct StbiFree16 {
+        void operator()(stbi_us* p) const { stbi_image_free(p); }
+    };
+
+    // Copies the first `kept` of `stored` interleaved channels.
+    template <typename T>
+    std::vector<T> KeepLeadingChannels(const T* src, size_t pixels, int stored, int kept) {
+        std::vector<T> out(pixels * kept);
+        for (size_t i = 0; i < pixels; ++i) {
+            std::memcpy(&out[i * kept], &src[i * stored], sizeof(T) * kept);
+        }
+        return out;
     }
-    glGenTextures(1, &this->textureID);
-    glBindTexture(GL_TEXTURE_2D, this->textureID);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, this->width, this->height, 0, GL_RGB, GL_UNSIGNED_BYTE, texData);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // v / 65535 as a half float, rounded to nearest even. Inputs are in [0, 1], so only the
+    // normal and denormal cases exist (no infinities or NaNs).
+    constexpr uint32_t kHalfMinNormal = 113u << 23;                       // 2^-14 as float bits
+    constexpr uint32_t kHalfDenormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+    constexpr uint32_t kHalfRebias = 0xfffu - (112u << 23);               // exponent 127 -> 15, plus rounding
+
+    uint16_t HalfFromUnorm16(uint16_t v) {
+        const float f = v * (1.0f / 65535.0f);
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        if (u < kHalfMinNormal) {
+            float magic;
+            std::memcpy(&magic, &kHalfDenormMagic, sizeof(magic));
+            const float d = f + magic;
+            std::memcpy(&u, &d, sizeof(u));
+            return (uint16_t)(u - kHalfDenormMagic);
+        }
+        return (uint16_t)((u + kHalfRebias + ((u >> 13) & 1)) >> 13);
+    }
 
-    //glBindTexture(GL_TEXTURE_2D, 0);
+#ifdef TEXTURE_SSE2
+    __m128i HalfFromFloat4(__m128 f) {
+        const __m128i u = _mm_castps_si128(f);
+        const __m128i magic = _mm_set1_epi32((int)kHalfDenormMagic);
+        const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(f, _mm_castsi128_ps(magic))), magic);
+        const __m128i odd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+        const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32((int)kHalfRebias)), odd), 13);
+        const __m128i isDenormal = _mm_cmplt_epi32(u, _mm_set1_epi32((int)kHalfMinNormal));
+        return _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+    }
+#endif
 
-    stbi_image_free(texData);
-    printf("Texture 2D in RGB format Loaded!\n");
-    printf("width>%i\n", this->width);
-    printf("height>%i\n", this->height);
-    printf("depth>%i\n", this->bitDepht);
+    // Same results as HalfFromUnorm16 per value; SSE2 converts eight at a time.
+    void HalfFromUnorm16(const uint16_t* src, uint16_t* dst, size_t count) {
+        size_t i = 0;
+#ifdef TEXTURE_SSE2
+        const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= count; i += 8) {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            const __m128i lo = HalfFromFloat4(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+            const __m128i hi = HalfFromFloat4(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+            // halves of [0, 1] are <= 0x3c00, so the signed pack never saturates
+            _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < count; ++i) dst[i] = HalfFromUnorm16(src[i]);
+    }
+
+    GLsizei FullMipCount(GLsizei width, GLsizei height, GLsizei depth) {
+        GLsizei levels = 1;
+        for (GLsizei size = std::max({ width, height, depth }); size > 1; size >>= 1) ++levels;
+        return levels;
+    }
+
+    // Splits one level into regions of whole slices (3D) or whole rows (2D) of at most
+    // maxRegionBytes; a unit row is `rowsPerUnit` texel rows (4 for block-compressed data).
+    void AddLevelRegions(TextureUpload& upload, GLint level, GLsizei w, GLsizei h, GLsizei d,
+        const unsigned char* texels, size_t rowBytes, GLsizei rowsPerUnit, size_t maxRegionBytes) {
+        const GLsizei units = (h + rowsPerUnit - 1) / rowsPerUnit;
+        const size_t sliceBytes = (size_t)units * rowBytes;
+        if (d > 1) {
+            const GLsizei step = maxRegionBytes ? (GLsizei)std::max<size_t>(1, maxRegionBytes / sliceBytes) : d;
+            for (GLsizei z = 0; z < d; z += step) {
+                const GLsizei n = std::min(step, d - z);
+                upload.regions.push_back({ level, 0, 0, z, w, h, n, texels + z * sliceBytes, n * sliceBytes });
+            }
+            return;
+        }
+        const GLsizei step = maxRegionBytes ? (GLsizei)std::max<size_t>(1, maxRegionBytes / rowBytes) : units;
+        for (GLsizei u = 0; u < units; u += step) {
+            const GLsizei n = std::min(step, units - u);
+            const GLsizei y = u * rowsPerUnit;
+            upload.regions.push_back({ level, 0, y, 0, w, std::min(n * rowsPerUnit, h - y), 1, texels + u * rowBytes, n * rowBytes });
+        }
+    }
+
+    const char* FormatName(GLenum internalFormat) {
+        switch (internalFormat) {
+        case GL_R8: return "R8";
+        case GL_RG8: return "RG8";
+        case GL_RGB8: return "RGB8";
+        case GL_RGBA8: return "RGBA8";
+        case GL_SRGB8: return "SRGB8";
+        case GL_SRGB8_ALPHA8: return "SRGB8_ALPHA8";
+        case GL_R16F: return "R16F";
+        case GL_RG16F: return "RG16F";
+        case GL_RGB16F: return "RGB16F";
+        case GL_RGBA16F: return "RGBA16F";
+        case GL_COMPRESSED_RED_RGTC1: return "BC4";
+        case GL_COMPRESSED_RG_RGTC2: return "BC5";
+        default: return "?";
+        }
+    }
+}
+
+GLenum TextureImport::internalFormat(GLenum pixelType) const {
+    static const GLenum unorm8[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+    static const GLenum half[] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+    const int c = std::clamp(channels, 1, 4) - 1;
+    if (pixelType == GL_HALF_FLOAT) return half[c];
+    // Core GL has no one- or two-channel sRGB formats.
+    if (srgb && c == 2) return GL_SRGB8;
+    if (srgb && c == 3) return GL_SRGB8_ALPHA8;
+    return unorm8[c];
+}
+
+size_t TextureUpload::gpuBytes() const {
+    size_t texelBytes = 4, blockBytes = 0;
+    switch (internalFormat) {
+    case GL_R8: texelBytes = 1; break;
+    case GL_RG8: case GL_R16F: texelBytes = 2; break;
+    case GL_RGB16F: case GL_RGBA16F: texelBytes = 8; break; // RGB is padded to four channels
+    case GL_COMPRESSED_RED_RGTC1: blockBytes = 8; break;
+    case GL_COMPRESSED_RG_RGTC2: blockBytes = 16; break;
+    default: break;
+    }
+    size_t total = 0;
+    for (GLsizei level = 0; level < levels; ++level) {
+        const size_t w = (size_t)std::max(1, width >> level);
+        const size_t h = (size_t)std::max(1, height >> level);
+        const size_t d = target == GL_TEXTURE_3D ? (size_t)std::max(1, depth >> level) : 1;
+        total += blockBytes ? (w + 3) / 4 * ((h + 3) / 4) * d * blockBytes : w * h * d * texelBytes;
+    }
+    return total;
+}
+
+TextureData Texture::Decode(const std::string& path, int desiredChannels) {
+    const auto start = std::chrono::steady_clock::now();
+
+    TextureData data;
+    data.path = path;
+    data.pixels.reset(stbi_load(path.c_str(), &data.width, &data.height, &data.fileChannels, desiredChannels));
+    data.channels = desiredChannels ? desiredChannels : data.fileChannels;
+    if (!data.pixels) {
+        const char* reason = stbi_failure_reason();
+        data.error = reason ? reason : "unknown error";
+    }
+
+    data.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return data;
+}
+
+TextureData Texture::Decode(const std::string& path, const TextureImport& import) {
+    const auto start = std::chrono::steady_clock::now();
+
+    TextureData data;
+    data.path = path;
+    int fileChannels = 0;
+    if (!stbi_info(path.c_str(), &data.width, &data.height, &fileChannels)) {
+        const char* reason = stbi_failure_reason();
+        data.error = reason ? reason : "unknown error";
+        return data;
+    }
+    // stbi folds RGB into luminance when asked for fewer channels; data textures keep
+    // their leading channels instead, so only let it expand.
+    const int desired = import.channels >= fileChannels ? import.channels : 0;
+    const int stored = desired ? desired : fileChannels;
+    const size_t pixels = (size_t)data.width * data.height;
+    data.fileChannels = fileChannels;
+    data.channels = import.channels;
+
+    if (import.bitDepth == 16 && stbi_is_16_bit(path.c_str())) {
+        std::unique_ptr<stbi_us, StbiFree16> wide(stbi_load_16(path.c_str(), &data.width, &data.height, &fileChannels, desired));
+        if (wide) {
+            std::vector<uint16_t> kept;
+            const uint16_t* src = wide.get();
+            if (stored != import.channels) {
+                kept = KeepLeadingChannels(src, pixels, stored, import.channels);
+                src = kept.data();
+            }
+            data.generated.resize(pixels * import.channels * sizeof(uint16_t));
+            HalfFromUnorm16(src, (uint16_t*)data.generated.data(), pixels * import.channels);
+            data.pixelType = GL_HALF_FLOAT;
+        }
+    }
+    else {
+        data.pixels.reset(stbi_load(path.c_str(), &data.width, &data.height, &fileChannels, desired));
+        if (data.pixels && stored != import.channels) {
+            std::vector<unsigned char> kept = KeepLeadingChannels(data.pixels.get(), pixels, stored, import.channels);
+            data.generated.swap(kept);
+            data.pixels.reset();
+        }
+    }
+    if (!data) {
+        const char* reason = stbi_failure_reason();
+        data.error = reason ? reason : "unknown error";
+    }
+
+    data.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return data;
+}
+
+TextureData Texture::DecodeVolume(const std::string& path) {
+    const auto start = std::chrono::steady_clock::now();
+
+    TextureData data;
+    data.path = path;
+    try {
+        data.volume = std::make_unique<MappedVolume>(path);
+        const VolumeHeader& header = data.volume->getHeader();
+        data.width = (int)header.width;
+        data.height = (int)header.height;
+        data.channels = data.fileChannels = (int)header.channels;
+    }
+    catch (const std::exception& e) {
+        data.error = e.what();
+    }
+
+    data.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return data;
+}
+
+TextureData Texture::GenerateNoise(const NoiseGenerator::Settings& settings) {
+    const auto start = std::chrono::steady_clock::now();
+
+    TextureData data;
+    data.path = NoiseGenerator::VolumeName(settings.volume);
+    try {
+        data.generated = NoiseGenerator::Generate(settings);
+        data.width = (int)settings.size;
+        data.height = (int)(settings.size * settings.size);
+        data.channels = data.fileChannels = 4;
+    }
+    catch (const std::exception& e) {
+        data.error = e.what();
+    }
+
+    data.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return data;
+}
 
+bool Texture::CreateStorage2D(GLsizei width, GLsizei height, GLenum internalFormat) {
+    glCreateTextures(GL_TEXTURE_2D, 1, &this->textureID);
+    if (!this->textureID) return false;
+    glTextureStorage2D(this->textureID, 1, internalFormat, width, height);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    this->width = width;
+    this->height = height;
+    return true;
+}
+
+bool Texture::CreateStorage3D(GLsizei size, GLenum internalFormat, GLsizei levels) {
+    if (levels <= 0) {
+        levels = 1;
+        while ((size >> levels) > 0) ++levels;
+    }
+    glCreateTextures(GL_TEXTURE_3D, 1, &this->textureID);
+    if (!this->textureID) return false;
+    glTextureStorage3D(this->textureID, levels, internalFormat, size, size, size);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    this->width = size;
+    this->height = size * size;
     return true;
 }
 
+bool Texture::LoadTexture() {
+    const TextureImport rgb = TextureImport::Data(3);
+    return Upload(Decode(this->fileLocation, rgb), rgb);
+}
+
 bool Texture::LoadTextureA() {
-    unsigned char* texData = stbi_load(this->fileLocation, &this->width, &this->height, &this->bitDepht, 0);
-    if (!texData) {
+    return UploadTextureA(Decode(this->fileLocation, 4));
+}
+
+bool Texture::UploadTextureA(const TextureData& data) {
+    return Upload(data, TextureImport());
+}
+
+bool Texture::LoadTexture3D() {
+    return UploadTexture3D(Decode(this->fileLocation, 4));
+}
+
+bool Texture::UploadTexture3D(const TextureData& data) {
+    return Upload(data, TextureImport::Volume());
+}
+
+bool Texture::LoadVolume() {
+    return UploadVolume(DecodeVolume(this->fileLocation));
+}
+
+bool Texture::UploadVolume(const TextureData& data) {
+    return data.volume != nullptr && Upload(data, TextureImport());
+}
+
+bool Texture::Upload(const TextureData& data, const TextureImport& import, size_t* gpuBytes) {
+    TextureUpload upload;
+    if (!BeginUpload(data, import, upload)) return false;
+    // Rows of R8/RG8/RGB8 images are not 4-byte aligned.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const TextureRegion& region : upload.regions) UploadRegion(upload, region, region.texels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    FinishUpload(upload);
+    if (gpuBytes) *gpuBytes = upload.gpuBytes();
+    return true;
+}
+
+bool Texture::SupportsCompressed3D() {
+    // Core GL only promises RGTC for 2D and 2D array targets; ask the driver once whether
+    // it also takes 3D textures. A format query, unlike a trial upload, raises no GL error.
+    static const bool supported = [] {
+        GLint ok = GL_FALSE;
+        glGetInternalformativ(GL_TEXTURE_3D, GL_COMPRESSED_RED_RGTC1, GL_INTERNALFORMAT_SUPPORTED, 1, &ok);
+        return ok == GL_TRUE;
+    }();
+    return supported;
+}
+
+bool Texture::BeginUpload(const TextureData& data, const TextureImport& import, TextureUpload& upload, size_t maxRegionBytes) {
+    if (!data) {
         printf("Failed Loading the file texture\n");
         return false;
     }
-    glGenTextures(1, &this->textureID);
-    glBindTexture(GL_TEXTURE_2D, this->textureID);
+    upload = TextureUpload();
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->width, this->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (data.volume) {
+        VolumeHeader header = data.volume->getHeader();
+        const unsigned char* texels = data.volume->getLevel(0);
+        // RGTC volumes the driver cannot take as 3D are expanded to R8/RG8 instead.
+        if (IsBlockCompressed(header.format) && header.depth > 1 && !SupportsCompressed3D()) {
+            upload.expanded = DecompressVolume(header, texels);
+            texels = upload.expanded.data();
+        }
+        switch ((VolumeFormat)header.format) {
+        case VolumeFormat::R8:    upload.format = GL_RED;  upload.internalFormat = GL_R8;    break;
+        case VolumeFormat::RG8:   upload.format = GL_RG;   upload.internalFormat = GL_RG8;   break;
+        case VolumeFormat::RGBA8: upload.format = GL_RGBA; upload.internalFormat = GL_RGBA8; break;
+        case VolumeFormat::BC4:   upload.internalFormat = GL_COMPRESSED_RED_RGTC1;           break;
+        case VolumeFormat::BC5:   upload.internalFormat = GL_COMPRESSED_RG_RGTC2;            break;
+        default:
+            printf("Failed Loading the file texture: unknown volume format %u\n", header.format);
+            return false;
+        }
+        const bool compressed = upload.format == 0;
+        upload.target = header.depth > 1 ? GL_TEXTURE_3D : GL_TEXTURE_2D;
+        upload.width = (GLsizei)header.width;
+        upload.height = (GLsizei)header.height;
+        upload.depth = (GLsizei)header.depth;
+        // Uncompressed files baked without mips get the chain built by the driver.
+        upload.generateMips = header.mipCount == 1 && !compressed;
+        upload.levels = upload.generateMips ? FullMipCount(upload.width, upload.height, upload.depth) : (GLsizei)header.mipCount;
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+        const size_t blockBytes = header.format == (uint32_t)VolumeFormat::BC4 ? 8 : 16;
+        for (uint32_t level = 0; level < header.mipCount; ++level) {
+            const GLsizei w = (GLsizei)std::max(1u, header.width >> level);
+            const GLsizei h = (GLsizei)std::max(1u, header.height >> level);
+            const GLsizei d = (GLsizei)std::max(1u, header.depth >> level);
+            // a 4x4 block row for RGTC, a texel row otherwise
+            const size_t rowBytes = compressed ? (size_t)((w + 3) / 4) * blockBytes : (size_t)w * header.channels;
+            AddLevelRegions(upload, (GLint)level, w, h, d, texels, rowBytes, compressed ? 4 : 1, maxRegionBytes);
+            texels += VolumeLevelSize(header, level);
+        }
+    }
+    else if (import.volume) {
+        if (data.channels != 4 || data.height != data.width * data.width) {
+            printf("Failed Loading the file texture\n");
+            return false;
+        }
+        // Cube strip: the slices are stacked vertically, so the strip already is the z-major volume.
+        upload.target = GL_TEXTURE_3D;
+        upload.internalFormat = GL_RGBA8;
+        upload.format = GL_RGBA;
+        upload.width = upload.height = upload.depth = data.width;
+        upload.levels = FullMipCount(data.width, data.width, data.width);
+        // distant cloud samples read the small levels (textureLod in cloud_density.glsl)
+        upload.generateMips = true;
+        AddLevelRegions(upload, 0, data.width, data.width, data.width, data.bytes(), (size_t)data.width * 4, 1, maxRegionBytes);
+    }
+    else {
+        if (data.channels != import.channels || data.channels < 1 || data.channels > 4) {
+            printf("Failed Loading the file texture\n");
+            return false;
+        }
+        static const GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        upload.internalFormat = import.internalFormat(data.pixelType);
+        upload.format = formats[data.channels - 1];
+        upload.type = data.pixelType;
+        upload.width = data.width;
+        upload.height = data.height;
+        upload.levels = import.mips ? FullMipCount(data.width, data.height, 1) : 1;
+        upload.generateMips = import.mips;
+        const size_t texelBytes = (size_t)data.channels * (data.pixelType == GL_HALF_FLOAT ? 2 : 1);
+        AddLevelRegions(upload, 0, data.width, data.height, 1, data.bytes(), (size_t)data.width * texelBytes, 1, maxRegionBytes);
+    }
 
-    stbi_image_free(texData);
+    glCreateTextures(upload.target, 1, &this->textureID);
+    if (!this->textureID) return false;
+    if (upload.target == GL_TEXTURE_3D) glTextureStorage3D(this->textureID, upload.levels, upload.internalFormat, upload.width, upload.height, upload.depth);
+    else glTextureStorage2D(this->textureID, upload.levels, upload.internalFormat, upload.width, upload.height);
 
-    printf("\n==================================\n");
-    printf("Texture 2D in RGBA format Loaded!\n");
-    printf("width>%i\n", this->width);
-    printf("height>%i\n", this->height);
-    printf("depth>%i\n", this->bitDepht);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_S, import.wrap);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_T, import.wrap);
+    glTextureParameteri(this->textureID, GL_TEXTURE_WRAP_R, import.wrap);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MIN_FILTER, upload.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(this->textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    if (import.gray && upload.format == GL_RED) {
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+        glTextureParameteriv(this->textureID, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
 
+    this->width = upload.width;
+    this->height = upload.target == GL_TEXTURE_3D ? upload.height * upload.depth : upload.height;
+    this->bitDepht = data.fileChannels;
     return true;
 }
 
-bool Texture::LoadTexture3D() {
-    unsigned char* texData3D = stbi_load(this->fileLocation, &this->width, &this->height, &this->bitDepht, 0);
-    if (!texData3D) {
-        printf("Failed Loading the file texture\n");
-        return false;
+void Texture::UploadRegion(const TextureUpload& upload, const TextureRegion& r, const void* source) const {
+    if (upload.format == 0) {
+        if (upload.target == GL_TEXTURE_3D) glCompressedTextureSubImage3D(this->textureID, r.level, r.x, r.y, r.z, r.width, r.height, r.depth, upload.internalFormat, (GLsizei)r.size, source);
+        else glCompressedTextureSubImage2D(this->textureID, r.level, r.x, r.y, r.width, r.height, upload.internalFormat, (GLsizei)r.size, source);
     }
-    glGenTextures(1, &this->textureID);
-    glBindTexture(GL_TEXTURE_3D, this->textureID);
-    //
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, this->width, this->width, this->width, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData3D);
-    glBindTexture(GL_TEXTURE_3D, 0);
-    stbi_image_free(texData3D);
+    else if (upload.target == GL_TEXTURE_3D) glTextureSubImage3D(this->textureID, r.level, r.x, r.y, r.z, r.width, r.height, r.depth, upload.format, upload.type, source);
+    else glTextureSubImage2D(this->textureID, r.level, r.x, r.y, r.width, r.height, upload.format, upload.type, source);
+}
+
+void Texture::FinishUpload(const TextureUpload& upload) {
+    if (upload.generateMips) glGenerateTextureMipmap(this->textureID);
 
     printf("\n==================================\n");
-    printf("Texture 3D in RGBA format Loaded!\n");
-    printf("width>%i\n", this->width);
-    printf("height>%i\n", this->height);
+    printf("Texture %s in %s format Loaded!\n", upload.target == GL_TEXTURE_3D ? "3D" : "2D", FormatName(upload.internalFormat));
+    printf("size>%ix%ix%i\n", upload.width, upload.height, upload.depth);
+    printf("mips>%i\n", upload.levels);
     printf("depth>%i\n", this->bitDepht);
-    return true;
 }
+
 bool Texture::LoadTexture1D() {
-    unsigned char* textdata1D = stbi_load(this->fileLocation, &this->width, &this->height, &this->bitDepht, 0);
+    unsigned char* textdata1D = stbi_load(this->fileLocation.c_str(), &this->width, &this->height, &this->bitDepht, 0);
     if (!textdata1D) {
         printf("Failed loading the file 1D texture\n");
         return false;
@@ -106,53 +484,32 @@ bool Texture::LoadTexture1D() {
     return true;
 }
 bool Texture::LoadTexture2DGray() {
-    unsigned char* texData = stbi_load(this->fileLocation, &this->width, &this->height, &this->bitDepht, 0);
-    if (!texData) {
-        printf("Failed Loading the file texture\n");
-        return false;
-    }
-    glGenTextures(1, &this->textureID);
-    glBindTexture(GL_TEXTURE_2D, this->textureID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, this->width, this->height, 0, GL_RED, GL_UNSIGNED_BYTE, texData);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    stbi_image_free(texData);
-    printf("\n==================================\n");
-    printf("Texture 2D in Grayscale format Loaded!\n");
-    printf("width>%i\n", this->width);
-    printf("height>%i\n", this->height);
-    printf("depth>%i\n", this->bitDepht);
-
-    return true;
+    const TextureImport gray = TextureImport::Gray();
+    return Upload(Decode(this->fileLocation, gray), gray);
 }
 void Texture::UseTexture3D(GLint textureLocation, GLint indexTexture) {
 
-    glActiveTexture(GL_TEXTURE0 + indexTexture);
     glUniform1i(textureLocation, indexTexture);
-    glBindTexture(GL_TEXTURE_3D, this->textureID);
+    GLState::get().bindTexture(indexTexture, this->textureID);
 }
 
 
 void Texture::UseTexture(GLint textureLocation, GLint indexTexture) {
-    glActiveTexture(GL_TEXTURE0 + indexTexture);
     glUniform1i(textureLocation, indexTexture);
-    glBindTexture(GL_TEXTURE_2D, this->textureID);
+    GLState::get().bindTexture(indexTexture, this->textureID);
 }
 
 void Texture::UseTexture1D(GLint textureLocation, GLint indexTexture) {
-    glActiveTexture(GL_TEXTURE0 + indexTexture);
     glUniform1i(textureLocation, indexTexture);
-    glBindTexture(GL_TEXTURE_1D, this->textureID);
+    GLState::get().bindTexture(indexTexture, this->textureID);
 }
 void Texture::ClearTexture() {
-    glDeleteTextures(1, &textureID);
+    // Nothing to tell GL (or the render thread's state tracker) about for an empty texture,
+    // e.g. a failed load dropped on the GLLoader thread.
+    if (textureID) {
+        glDeleteTextures(1, &textureID);
+        GLState::get().textureDeleted(textureID);
+    }
     this->textureID = 0;
     this->width = 0;
     this->height = 0;
@@ -1,16 +1,124 @@
 #pragma once
 #include <GL/glew.h>
 #include "stb_image.hpp"
+#include "VolumeFile.hpp"
+#include "NoiseGenerator.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct StbiFree {
+    void operator()(unsigned char* p) const { stbi_image_free(p); }
+};
+
+// CPU half of a texture load. Produced by Texture::Decode on any thread, consumed by
+// the Upload* methods on the GL thread.
+struct TextureData {
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int channels = 0;      // channels stored in pixels
+    int fileChannels = 0;  // channels in the file
+    GLenum pixelType = GL_UNSIGNED_BYTE;   // GL_HALF_FLOAT for 16-bit imports
+    std::unique_ptr<unsigned char, StbiFree> pixels;
+    std::unique_ptr<MappedVolume> volume;  // set instead of pixels for baked .vol files
+    std::vector<unsigned char> generated;  // set instead of pixels for procedural or converted texels
+    std::string error;
+    double decodeMs = 0.0;
+
+    const unsigned char* bytes() const { return pixels ? pixels.get() : generated.data(); }
+    explicit operator bool() const { return pixels != nullptr || volume != nullptr || !generated.empty(); }
+};
+
+// Per-asset import settings: what is kept from the file and how it lives on the GPU.
+// internalFormat() picks the smallest format that holds it (R8 for gray, R16F for 16-bit data...).
+struct TextureImport {
+    int channels = 4;         // fewer than the file keeps its leading channels
+    int bitDepth = 8;         // 16 decodes 16-bit files with stbi_load_16 into half floats
+    bool srgb = false;        // 8-bit RGB/RGBA colour only
+    bool gray = false;        // single channel sampled as (r, r, r, 1)
+    bool mips = true;
+    GLenum wrap = GL_REPEAT;
+    bool volume = false;      // cube strip (height = width^2) uploaded as a 3D texture
+
+    static TextureImport Color() { TextureImport i; i.srgb = true; return i; }
+    static TextureImport Gray() { TextureImport i; i.channels = 1; i.gray = true; return i; }
+    static TextureImport Data(int channels, int bitDepth = 8) { TextureImport i; i.channels = channels; i.bitDepth = bitDepth; return i; }
+    static TextureImport Volume() { TextureImport i; i.volume = true; return i; }
+
+    GLenum internalFormat(GLenum pixelType = GL_UNSIGNED_BYTE) const;
+};
+
+// One sub-image copy: a box of one mip level and where its texels start in the source.
+struct TextureRegion {
+    GLint level = 0;
+    GLint x = 0, y = 0, z = 0;
+    GLsizei width = 0, height = 0, depth = 1;
+    const unsigned char* texels = nullptr;
+    size_t size = 0;
+};
+
+// Immutable storage of a decoded texture and the regions that fill it (see Texture::BeginUpload).
+// The regions point into the TextureData, which has to outlive the upload.
+struct TextureUpload {
+    GLenum target = GL_TEXTURE_2D;
+    GLenum internalFormat = 0;
+    GLenum format = 0;                     // 0 for block-compressed data
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLsizei width = 0, height = 0, depth = 1;
+    GLsizei levels = 1;
+    bool generateMips = false;             // the source only carries level 0
+    std::vector<TextureRegion> regions;
+    std::vector<unsigned char> expanded;   // texels of RGTC volumes decompressed on the CPU
+
+    // GL memory of the whole storage (all levels), for budgeting.
+    size_t gpuBytes() const;
+};
 
 class Texture {
 public:
     Texture(const char* fileLoc = "") :textureID(0), width(0), height(0), bitDepht(0), fileLocation(fileLoc) {};
 
+    // ** Decode only: no GL calls, safe on worker threads. desiredChannels 0 keeps the file's count.
+    static TextureData Decode(const std::string& path, int desiredChannels = 0);
+    // ** Decode for an import descriptor: keeps import.channels, 16-bit files become half floats.
+    static TextureData Decode(const std::string& path, const TextureImport& import);
+    // ** Maps a baked .vol file and verifies its checksum; no copy of the voxels is made.
+    static TextureData DecodeVolume(const std::string& path);
+    // ** Procedural 3D noise in the cube strip layout (see NoiseGenerator); worker-thread safe.
+    static TextureData GenerateNoise(const NoiseGenerator::Settings& settings);
+    // ** Synchronous GL upload of decoded data (render thread) into immutable storage:
+    // 2D in import.internalFormat(), a cube strip when import.volume, or every mip of a mapped
+    // .vol (2D when its depth is 1, RGTC for BC4/BC5 files). gpuBytes receives the storage size.
+    bool Upload(const TextureData& data, const TextureImport& import, size_t* gpuBytes = nullptr);
+    // ** A = RGBA 2D, 3D = cube strip (height = width^2), Volume = baked .vol
+    bool UploadTextureA(const TextureData& data);
+    bool UploadTexture3D(const TextureData& data);
+    bool UploadVolume(const TextureData& data);
+
+    // ** Split upload, used by TextureStreamer: BeginUpload allocates the storage and lists the
+    // regions (whole slices or rows, at most maxRegionBytes each; 0 = one per level),
+    // UploadRegion copies one from `source` (client pointer, or offset into the bound
+    // GL_PIXEL_UNPACK_BUFFER), FinishUpload builds the missing mips.
+    bool BeginUpload(const TextureData& data, const TextureImport& import, TextureUpload& upload, size_t maxRegionBytes = 0);
+    void UploadRegion(const TextureUpload& upload, const TextureRegion& region, const void* source) const;
+    void FinishUpload(const TextureUpload& upload);
+    // ** Whether the driver accepts RGTC for 3D textures (probed once, GL thread)
+    static bool SupportsCompressed3D();
+
+    // ** Empty immutable storage (glTextureStorage*), e.g. for compute shader output.
+    // 2D has one level; 3D levels <= 0 allocates the full mip chain.
+    bool CreateStorage2D(GLsizei width, GLsizei height, GLenum internalFormat);
+    bool CreateStorage3D(GLsizei size, GLenum internalFormat, GLsizei levels = 0);
+
     bool LoadTexture();
     // ** Work with alpha channel
     bool LoadTextureA();
     // ** 3D Texture
     bool LoadTexture3D();
+    // ** 3D Texture from a baked .vol file
+    bool LoadVolume();
     // ** 1D Texture Load in Grayscale
     bool LoadTexture1D();
     // ** Load Texture GrayScale
@@ -21,12 +129,12 @@ public:
     void UseTexture3D(GLint, GLint);
 
     void ClearTexture();
-    GLuint GetID() { return textureID; }
+    GLuint GetID() const { return textureID; }
     ~Texture();
 
 private:
     GLuint textureID;
     int width, height, bitDepht;
 
-    const char* fileLocation;
+    std::string fileLocation;
 };
\ No newline at end of file
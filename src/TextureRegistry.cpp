@@ -0,0 +1,68 @@
+#include "TextureRegistry.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+std::string TextureRegistry::MakeKey(const std::string& path, const TextureImport& import) {
+    // Different spellings of one file ("textures/../textures/x.png") share an entry;
+    // names that are not files (generated textures) are used as they are.
+    std::error_code ec;
+    std::string key = path;
+    if (std::filesystem::exists(path, ec)) {
+        const std::filesystem::path resolved = std::filesystem::canonical(path, ec);
+        if (!ec) key = resolved.generic_string();
+    }
+
+    char settings[96];
+    std::snprintf(settings, sizeof(settings), "|c%d b%d s%d g%d m%d w%x v%d", import.channels, import.bitDepth,
+        (int)import.srgb, (int)import.gray, (int)import.mips, import.wrap, (int)import.volume);
+    return key + settings;
+}
+
+TextureRegistry::Handle TextureRegistry::find(const std::string& key) {
+    auto it = entries.find(key);
+    if (it == entries.end()) return nullptr;
+    it->second.lastUse = ++useClock;
+    return it->second.texture;
+}
+
+TextureRegistry::Handle TextureRegistry::insert(const std::string& key, std::unique_ptr<Texture> texture, size_t bytes) {
+    Entry& entry = entries[key];
+    usedBytes -= entry.bytes;
+    entry.texture = std::move(texture);
+    entry.bytes = bytes;
+    entry.lastUse = ++useClock;
+    usedBytes += bytes;
+
+    Handle handle = entry.texture;
+    trim();
+    return handle;
+}
+
+void TextureRegistry::clear() {
+    entries.clear();
+    usedBytes = 0;
+}
+
+void TextureRegistry::setBudget(size_t bytes) {
+    budget = bytes;
+    trim();
+}
+
+void TextureRegistry::trim() {
+    while (usedBytes > budget) {
+        // Only the registry holds an unused entry's handle.
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->second.texture.use_count() > 1) continue;
+            if (victim == entries.end() || it->second.lastUse < victim->second.lastUse) victim = it;
+        }
+        if (victim == entries.end()) return; // everything left is bound somewhere
+
+        std::fprintf(stderr, "[textures] evicting %s (%.1f MB, %.1f / %.1f MB in use)\n", victim->first.c_str(),
+            victim->second.bytes / 1048576.0, usedBytes / 1048576.0, budget / 1048576.0);
+        usedBytes -= victim->second.bytes;
+        entries.erase(victim);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Texture.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Shared textures keyed by resolved path + import settings, so slots naming the same file
+// share one GL object and a texture comes back without decoding again. Entries that no one
+// else holds a handle to are evicted least recently used first once the tracked GL memory
+// exceeds the budget.
+class TextureRegistry {
+public:
+    using Handle = std::shared_ptr<Texture>;
+    static constexpr size_t kDefaultBudget = (size_t)256 << 20;
+
+    explicit TextureRegistry(size_t budgetBytes = kDefaultBudget) : budget(budgetBytes) {}
+
+    TextureRegistry(const TextureRegistry&) = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    static std::string MakeKey(const std::string& path, const TextureImport& import);
+
+    // Cached texture for the key, or null. Counts as a use.
+    Handle find(const std::string& key);
+    // Registers a finished texture, replacing an older entry for the key, and returns its handle.
+    Handle insert(const std::string& key, std::unique_ptr<Texture> texture, size_t bytes);
+    // Forgets every entry; handles already given out stay valid until released.
+    void clear();
+    // Evicts unused entries until the budget holds.
+    void trim();
+
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return budget; }
+    size_t getUsedBytes() const { return usedBytes; }
+    size_t getEntryCount() const { return entries.size(); }
+
+private:
+    struct Entry {
+        Handle texture;
+        size_t bytes = 0;
+        uint64_t lastUse = 0;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+    size_t budget = kDefaultBudget;
+    size_t usedBytes = 0;
+    uint64_t useClock = 0;
+};
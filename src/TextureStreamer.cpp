@@ -0,0 +1,103 @@
+#include "TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+TextureStreamer::TextureStreamer(GLsizeiptr ringSize) {
+    segmentSize = ringSize / kSegments / 256 * 256;
+    if (!GLEW_ARB_buffer_storage || segmentSize <= 0) {
+        std::fprintf(stderr, "[textures] no persistent mapping, streaming from client memory\n");
+        return;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, segmentSize * kSegments, nullptr, flags);
+    mapped = static_cast<uint8_t*>(glMapNamedBufferRange(buffer, 0, segmentSize * kSegments, flags));
+    if (!mapped) {
+        std::fprintf(stderr, "[textures] mapping the upload ring failed, streaming from client memory\n");
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+TextureStreamer::~TextureStreamer() {
+    for (GLsync& f : fences) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    if (buffer) {
+        glUnmapNamedBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+void TextureStreamer::beginFrame() {
+    budgetLeft = frameBudget;
+    // Rows of R8/RG8/RGB8 images are not 4-byte aligned.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+}
+
+void TextureStreamer::endFrame() {
+    // Fence what this frame wrote so the segment is reused only after the copies ran.
+    retireSegment();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void TextureStreamer::retireSegment() {
+    if (!mapped || used == 0) return;
+    fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    segment = (segment + 1) % kSegments;
+    used = 0;
+}
+
+uint8_t* TextureStreamer::allocate(size_t size, GLintptr& offset) {
+    // 16-byte offsets keep every pixel type aligned.
+    size = (size + 15) & ~(size_t)15;
+    if (used + size > (size_t)segmentSize) retireSegment();
+
+    if (fences[segment]) {
+        // Never wait here: a busy segment means the GPU is still copying, try next frame.
+        if (glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) return nullptr;
+        glDeleteSync(fences[segment]);
+        fences[segment] = nullptr;
+    }
+
+    offset = segment * segmentSize + (GLintptr)used;
+    used += size;
+    return mapped + offset;
+}
+
+bool TextureStreamer::stream(TextureStream& job) {
+    const std::vector<TextureRegion>& regions = job.upload.regions;
+    ++job.frames;
+    while (!job.done() && budgetLeft > 0) {
+        const TextureRegion& r = regions[job.next];
+        // The first region of a frame always goes, so one larger than the budget cannot stall.
+        if (r.size > budgetLeft && budgetLeft < frameBudget) break;
+
+        GLintptr offset = 0;
+        uint8_t* staging = nullptr;
+        if (mapped && r.size + 15 <= (size_t)segmentSize) {
+            staging = allocate(r.size, offset);
+            if (!staging) break;
+        }
+
+        if (staging) {
+            std::memcpy(staging, r.texels, r.size);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            job.texture->UploadRegion(job.upload, r, reinterpret_cast<const void*>(offset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else {
+            // No ring, or a single slice larger than a segment.
+            job.texture->UploadRegion(job.upload, r, r.texels);
+        }
+        budgetLeft -= std::min(budgetLeft, r.size);
+        ++job.next;
+    }
+    return job.done();
+}
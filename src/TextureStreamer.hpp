@@ -0,0 +1,67 @@
+#pragma once
+#include <GL/glew.h>
+
+#include "Texture.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// One texture in flight: the decoded source, its immutable storage and the next region to copy.
+struct TextureStream {
+    TextureData data;
+    TextureUpload upload;
+    std::unique_ptr<Texture> texture;
+    size_t next = 0;
+    int frames = 0;
+
+    bool done() const { return next == upload.regions.size(); }
+};
+
+// Streams texture regions through a persistently mapped GL_PIXEL_UNPACK_BUFFER ring split
+// into segments. A segment is fenced once the copies reading it are submitted and is only
+// rewritten after that fence has signalled; when none is free, stream() returns and
+// the job continues next frame instead of waiting. Each frame copies at most the frame
+// budget, so a noise volume or weather map spreads over a few frames rather than stalling one.
+// Without ARB_buffer_storage the same budget applies to plain client-memory uploads.
+class TextureStreamer {
+public:
+    static constexpr GLsizeiptr kDefaultRingSize = 8 << 20;
+    static constexpr int kSegments = 4;
+    static constexpr size_t kDefaultFrameBudget = 4 << 20;
+
+    explicit TextureStreamer(GLsizeiptr ringSize = kDefaultRingSize);
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // Region size to pass to Texture::BeginUpload so regions pack into the segments.
+    size_t getMaxRegionBytes() const { return mapped ? (size_t)segmentSize / 2 : frameBudget; }
+
+    void setFrameBudget(size_t bytes) { frameBudget = bytes ? bytes : 1; }
+    size_t getFrameBudget() const { return frameBudget; }
+    bool isPersistent() const { return mapped != nullptr; }
+
+    // beginFrame / endFrame bracket the stream() calls of one frame.
+    void beginFrame();
+    // Submits regions of `job` until it is done, the budget is spent or every segment is
+    // still being read. Returns true once all regions are submitted.
+    bool stream(TextureStream& job);
+    void endFrame();
+
+private:
+    uint8_t* allocate(size_t size, GLintptr& offset);
+    void retireSegment();
+
+    GLuint buffer = 0;
+    GLsizeiptr segmentSize = 0;
+    uint8_t* mapped = nullptr;
+
+    GLsync fences[kSegments] = {};
+    int segment = 0;
+    size_t used = 0;
+
+    size_t frameBudget = kDefaultFrameBudget;
+    size_t budgetLeft = 0;
+};
@@ -0,0 +1,207 @@
+#include "VolumeFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+uint64_t VolumeChecksum(const unsigned char* data, size_t size) {
+    // FNV-1a 64, the same hash the program binary cache keys use.
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t VolumeLevelSize(const VolumeHeader& header, uint32_t level) {
+    const size_t w = std::max<uint32_t>(1u, header.width >> level);
+    const size_t h = std::max<uint32_t>(1u, header.height >> level);
+    const size_t d = std::max<uint32_t>(1u, header.depth >> level);
+    if (IsBlockCompressed(header.format)) {
+        const size_t blockBytes = header.format == (uint32_t)VolumeFormat::BC4 ? 8 : 16;
+        return ((w + 3) / 4) * ((h + 3) / 4) * d * blockBytes;
+    }
+    return w * h * d * header.channels;
+}
+
+void AppendVolumeMips(VolumeHeader& header, std::vector<unsigned char>& data) {
+    const uint32_t channels = header.channels;
+    header.mipCount = 1;
+    data.resize(VolumeLevelSize(header, 0));
+
+    size_t srcOffset = 0;
+    uint32_t w = header.width, h = header.height, d = header.depth;
+    while (w > 1 || h > 1 || d > 1) {
+        const uint32_t nw = std::max(1u, w / 2), nh = std::max(1u, h / 2), nd = std::max(1u, d / 2);
+        const size_t dstOffset = data.size();
+        data.resize(dstOffset + (size_t)nw * nh * nd * channels);
+        const unsigned char* src = data.data() + srcOffset;
+        unsigned char* dst = data.data() + dstOffset;
+
+        for (uint32_t z = 0; z < nd; ++z)
+            for (uint32_t y = 0; y < nh; ++y)
+                for (uint32_t x = 0; x < nw; ++x)
+                    for (uint32_t c = 0; c < channels; ++c) {
+                        uint32_t sum = 0;
+                        for (uint32_t i = 0; i < 8; ++i) {
+                            // axes that are already 1 wide clamp instead of reading past the edge
+                            const uint32_t sx = std::min(w - 1, x * 2 + (i & 1));
+                            const uint32_t sy = std::min(h - 1, y * 2 + ((i >> 1) & 1));
+                            const uint32_t sz = std::min(d - 1, z * 2 + (i >> 2));
+                            sum += src[(((size_t)sz * h + sy) * w + sx) * channels + c];
+                        }
+                        dst[(((size_t)z * nh + y) * nw + x) * channels + c] = (unsigned char)((sum + 4) / 8);
+                    }
+
+        srcOffset = dstOffset;
+        w = nw; h = nh; d = nd;
+        ++header.mipCount;
+    }
+}
+
+bool WriteVolumeFile(const std::filesystem::path& path, VolumeHeader header, const unsigned char* data) {
+    header.magic = kVolumeMagic;
+    header.version = kVolumeVersion;
+    header.dataSize = 0;
+    for (uint32_t level = 0; level < header.mipCount; ++level) {
+        header.dataSize += VolumeLevelSize(header, level);
+    }
+    header.checksum = VolumeChecksum(data, (size_t)header.dataSize);
+
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data), (std::streamsize)header.dataSize);
+        if (!out) return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+namespace {
+    bool FormatMatchesChannels(uint32_t format, uint32_t channels) {
+        switch ((VolumeFormat)format) {
+        case VolumeFormat::R8:
+        case VolumeFormat::BC4:   return channels == 1;
+        case VolumeFormat::RG8:
+        case VolumeFormat::BC5:   return channels == 2;
+        case VolumeFormat::RGBA8: return channels == 4;
+        }
+        return false;
+    }
+
+    uint64_t TotalLevelSize(const VolumeHeader& header) {
+        uint64_t total = 0;
+        for (uint32_t level = 0; level < header.mipCount; ++level) {
+            total += VolumeLevelSize(header, level);
+        }
+        return total;
+    }
+}
+
+MappedVolume::MappedVolume(const std::filesystem::path& path, bool verifyChecksum) {
+#ifdef _WIN32
+    file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        throw std::runtime_error("Cannot open volume: " + path.string());
+    }
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(file, &fileSize);
+    size = (size_t)fileSize.QuadPart;
+    mapping = size ? CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    base = mapping ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open volume: " + path.string());
+    }
+    struct stat st {};
+    if (fstat(fd, &st) == 0) size = (size_t)st.st_size;
+    void* view = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    base = view == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(view);
+#endif
+
+    std::string error;
+    if (!base || size < sizeof(VolumeHeader)) {
+        error = "truncated or unmappable";
+    }
+    else {
+        std::memcpy(&header, base, sizeof(header));
+        if (header.magic != kVolumeMagic || header.version != kVolumeVersion) {
+            error = "not a version " + std::to_string(kVolumeVersion) + " volume";
+        }
+        else if (header.dataSize != size - sizeof(VolumeHeader)) {
+            error = "size mismatch";
+        }
+        else if (!FormatMatchesChannels(header.format, header.channels)) {
+            error = "format " + std::to_string(header.format) + " with " + std::to_string(header.channels) + " channels";
+        }
+        else if (!header.width || !header.height || !header.depth || !header.mipCount || header.mipCount > 32) {
+            error = "bad dimensions or mip count";
+        }
+        else if (TotalLevelSize(header) != header.dataSize) {
+            error = "levels do not add up to the data size";
+        }
+        else if (verifyChecksum && VolumeChecksum(base + sizeof(VolumeHeader), (size_t)header.dataSize) != header.checksum) {
+            error = "checksum mismatch";
+        }
+    }
+
+    if (!error.empty()) {
+        unmap();
+        throw std::runtime_error("Bad volume " + path.string() + ": " + error);
+    }
+}
+
+MappedVolume::~MappedVolume() {
+    unmap();
+}
+
+void MappedVolume::unmap() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (base) munmap(const_cast<unsigned char*>(base), size);
+#endif
+    base = nullptr;
+    size = 0;
+}
+
+const unsigned char* MappedVolume::getLevel(uint32_t level) const {
+    if (level >= header.mipCount) return nullptr;
+
+    size_t offset = sizeof(VolumeHeader);
+    for (uint32_t i = 0; i < level; ++i) {
+        offset += VolumeLevelSize(header, i);
+    }
+    return base + offset;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Baked volume container (.vol): a VolumeHeader followed by raw voxels, mip 0 first,
+// every level tightly packed (x fastest, then y, then z). Produced by tools/vol_convert.
+// depth 1 marks a 2D texture. Block-compressed levels store each slice's 4x4 blocks
+// row by row, slice after slice.
+constexpr uint32_t kVolumeMagic = 0x314C4F56; // "VOL1"
+constexpr uint32_t kVolumeVersion = 1;
+
+enum class VolumeFormat : uint32_t {
+    R8 = 1,
+    RG8 = 2,
+    RGBA8 = 4,
+    BC4 = 0x11,  // RGTC1, one channel, 8 bytes per 4x4 block
+    BC5 = 0x12,  // RGTC2, two channels, 16 bytes per 4x4 block
+};
+
+inline bool IsBlockCompressed(uint32_t format) {
+    return format == (uint32_t)VolumeFormat::BC4 || format == (uint32_t)VolumeFormat::BC5;
+}
+
+struct VolumeHeader {
+    uint32_t magic = kVolumeMagic;
+    uint32_t version = kVolumeVersion;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t depth = 0;
+    uint32_t format = 0;     // VolumeFormat
+    uint32_t channels = 0;
+    uint32_t mipCount = 1;
+    uint64_t dataSize = 0;   // bytes after the header, all levels
+    uint64_t checksum = 0;   // VolumeChecksum of those bytes
+};
+
+static_assert(sizeof(VolumeHeader) == 48, "VolumeHeader must stay 48 bytes");
+
+uint64_t VolumeChecksum(const unsigned char* data, size_t size);
+size_t VolumeLevelSize(const VolumeHeader& header, uint32_t level);
+
+// Appends box-filtered mips (2x2x2 average) below the single level in `data` down to
+// 1x1x1 and updates header.mipCount.
+void AppendVolumeMips(VolumeHeader& header, std::vector<unsigned char>& data);
+
+// Fills dataSize/checksum and writes header + data (via a temp file and rename).
+bool WriteVolumeFile(const std::filesystem::path& path, VolumeHeader header, const unsigned char* data);
+
+// Read-only memory mapping of a .vol file. Throws std::runtime_error when the file is
+// missing, truncated, of another version, has a format/channels or level sizes that
+// disagree with its header, or (if verified) fails its checksum.
+class MappedVolume {
+public:
+    explicit MappedVolume(const std::filesystem::path& path, bool verifyChecksum = true);
+    ~MappedVolume();
+
+    MappedVolume(const MappedVolume&) = delete;
+    MappedVolume& operator=(const MappedVolume&) = delete;
+
+    const VolumeHeader& getHeader() const { return header; }
+    const unsigned char* getLevel(uint32_t level) const;
+    size_t getLevelSize(uint32_t level) const { return VolumeLevelSize(header, level); }
+
+private:
+    void unmap();
+
+    VolumeHeader header;
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
@@ -1,4 +1,5 @@
 #include "Window.hpp"
+#include "GLState.hpp"
 
 Window::Window() : window(nullptr) {
 	if (!glfwInit()) {
@@ -33,6 +34,14 @@ Window::Window() : window(nullptr) {
 		return;
 	}
 
+	// Hidden 1x1 window whose context shares textures, buffers and programs with this one
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	loaderContext = glfwCreateWindow(1, 1, "loader", nullptr, window);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (!loaderContext) {
+		std::cerr << "No shared loader context, resources load on the render thread." << std::endl;
+	}
+
 	// Set the framebuffer size callback
 	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
@@ -40,7 +49,7 @@ Window::Window() : window(nullptr) {
 	if (windowResize) {
 		widthWindow = getWindowWidth();
 		heightWindow = getWindowHeight();
-		glViewport(0, 0, widthWindow, heightWindow);
+		GLState::get().viewport(0, 0, widthWindow, heightWindow);
 		windowResize = true;
 	}
 
@@ -73,7 +82,7 @@ void Window::framebufferSizeCallback(GLFWwindow* window, int width, int height)
 	yOffset = (height - size) / 2;
 
 	// Set the viewport
-	glViewport(xOffset, yOffset, size, size);
+	GLState::get().viewport(xOffset, yOffset, size, size);
 
 	// Set up orthographic projection
 	glMatrixMode(GL_PROJECTION);
@@ -90,6 +99,9 @@ const char* Window::titleWindow() {
 
 Window::~Window() {
 	std::cerr << "Window is being destroyed." << std::endl;
+	if (loaderContext) {
+		glfwDestroyWindow(loaderContext);
+	}
 	if (window) {
 		glfwDestroyWindow(window);
 	}
@@ -15,6 +15,8 @@ public:
 
 public:
 	GLFWwindow* getWindow() const;
+	// Hidden context sharing objects with the window's, for GLLoader (null if unavailable)
+	GLFWwindow* getLoaderContext() const { return loaderContext; }
 	virtual void setWindow(float width, float height) {
 		widthWindow = width;
 		heightWindow = height;
@@ -30,4 +32,5 @@ protected:
 
 private:
 	GLFWwindow* window;
+	GLFWwindow* loaderContext = nullptr;
 };
\ No newline at end of file
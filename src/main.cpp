@@ -1,8 +1,45 @@
 #include "Init.hpp"
 
-int main() {
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
 	Init init;
 
+	// --gpu-noise[=SIZE]: build the cloud noise with compute shaders (SIZE = low-frequency resolution)
+	// --texture-budget=MB: GL memory the texture cache may keep
+	// --weather=FILE: weather map to start with (M cycles through the bundled ones)
+	// --cloud-res=N: mode 8 clouds at 1/N resolution per axis (1, 2 or 4)
+	// --cloud-interleave: mode 8 marches one pixel per 4x4 block per frame and reprojects the rest
+	// --frame-budget=MS: GPU time per frame the dynamic resolution aims for (default: refresh interval)
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strncmp(argv[i], "--texture-budget=", 17)) {
+			init.setTextureBudget((size_t)std::strtoul(argv[i] + 17, nullptr, 10) << 20);
+		}
+		if (!std::strncmp(argv[i], "--cloud-res=", 12)) {
+			init.setCloudDownsample(std::atoi(argv[i] + 12));
+		}
+		if (!std::strncmp(argv[i], "--frame-budget=", 15)) {
+			init.setFrameBudget(std::atof(argv[i] + 15));
+		}
+		if (!std::strcmp(argv[i], "--cloud-interleave")) {
+			init.setCloudInterleave(true);
+		}
+		if (!std::strncmp(argv[i], "--weather=", 10)) {
+			init.setWeatherMap(argv[i] + 10);
+		}
+		if (!std::strncmp(argv[i], "--gpu-noise", 11)) {
+			init.setGpuNoise(true);
+			if (argv[i][11] == '=') {
+				GpuNoise::Resolution r;
+				r.lowFrequency = r.curl = (uint32_t)std::strtoul(argv[i] + 12, nullptr, 10);
+				r.highFrequency = std::max(8u, r.lowFrequency / 4);
+				init.setNoiseResolution(r);
+			}
+		}
+	}
+
 	init.initialize();
 
 	while (!init.shouldClose()) {
@@ -10,4 +47,4 @@ int main() {
 		init.render();
 		init.swapBuffersAndPollEvents();
 	}
-}
\ No newline at end of file
+}
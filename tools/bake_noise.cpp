@@ -0,0 +1,128 @@
+// Generates the tileable cloud noise volumes offline.
+//
+//   bake_noise <low|high> <size> <output.vol|output.tga> [--seed N] [--scalar] [--verify] [--mips]
+//
+// .vol output is memory-mapped by the editor (--mips stores the full mip chain);
+// .tga output is an uncompressed width x width^2 strip for LoadTexture3D. --verify regenerates through the scalar
+// path and fails if any voxel differs.
+
+#include "NoiseGenerator.hpp"
+#include "ThreadPool.hpp"
+#include "VolumeFile.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // 32-bit BGRA, top-left origin.
+    bool WriteTga(const std::string& path, uint32_t width, uint32_t height, const std::vector<unsigned char>& rgba) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        unsigned char header[18] = {};
+        header[2] = 2; // uncompressed true-color
+        header[12] = (unsigned char)(width & 0xff);
+        header[13] = (unsigned char)(width >> 8);
+        header[14] = (unsigned char)(height & 0xff);
+        header[15] = (unsigned char)(height >> 8);
+        header[16] = 32;
+        header[17] = 0x28; // 8 alpha bits, top-left origin
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        std::vector<unsigned char> bgra(rgba.size());
+        for (size_t i = 0; i < rgba.size(); i += 4) {
+            bgra[i + 0] = rgba[i + 2];
+            bgra[i + 1] = rgba[i + 1];
+            bgra[i + 2] = rgba[i + 0];
+            bgra[i + 3] = rgba[i + 3];
+        }
+        out.write(reinterpret_cast<const char*>(bgra.data()), (std::streamsize)bgra.size());
+        return (bool)out;
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::fprintf(stderr, "usage: %s <low|high> <size> <output.vol|output.tga> [--seed N] [--scalar] [--verify] [--mips]\n", argv[0]);
+        return 1;
+    }
+
+    NoiseGenerator::Settings settings;
+    if (!std::strcmp(argv[1], "low")) settings.volume = NoiseGenerator::Volume::LowFrequency;
+    else if (!std::strcmp(argv[1], "high")) settings.volume = NoiseGenerator::Volume::HighFrequency;
+    else {
+        std::fprintf(stderr, "unknown volume '%s' (expected low or high)\n", argv[1]);
+        return 1;
+    }
+    settings.size = (uint32_t)std::strtoul(argv[2], nullptr, 10);
+    const std::string output = argv[3];
+
+    bool verify = false;
+    bool mips = false;
+    for (int i = 4; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) settings.seed = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--scalar")) settings.simd = false;
+        else if (!std::strcmp(argv[i], "--verify")) verify = true;
+        else if (!std::strcmp(argv[i], "--mips")) mips = true;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<unsigned char> voxels;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        voxels = NoiseGenerator::Generate(settings, &pool);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    std::printf("%s %u^3 seed %u: %.1f ms on %u threads (%s)\n", NoiseGenerator::VolumeName(settings.volume),
+        settings.size, settings.seed, MsSince(start), pool.size(), settings.simd && NoiseGenerator::HasSimd() ? "SSE2" : "scalar");
+
+    if (verify) {
+        NoiseGenerator::Settings reference = settings;
+        reference.simd = false;
+        const auto verifyStart = std::chrono::steady_clock::now();
+        const std::vector<unsigned char> expected = NoiseGenerator::Generate(reference, &pool);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < voxels.size(); ++i) mismatches += voxels[i] != expected[i];
+        std::printf("scalar reference: %.1f ms, %zu mismatching bytes\n", MsSince(verifyStart), mismatches);
+        if (mismatches) return 1;
+    }
+
+    bool written = false;
+    if (std::filesystem::path(output).extension() == ".tga") {
+        written = WriteTga(output, settings.size, settings.size * settings.size, voxels);
+    }
+    else {
+        VolumeHeader header;
+        header.width = header.height = header.depth = settings.size;
+        header.format = (uint32_t)VolumeFormat::RGBA8;
+        header.channels = 4;
+        std::vector<unsigned char> data = voxels;
+        if (mips) AppendVolumeMips(header, data);
+        written = WriteVolumeFile(output, header, data.data());
+    }
+    if (!written) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        return 1;
+    }
+    std::printf("wrote %s (%zu bytes of voxels, checksum %016llx)\n", output.c_str(), voxels.size(),
+        (unsigned long long)VolumeChecksum(voxels.data(), voxels.size()));
+    return 0;
+}
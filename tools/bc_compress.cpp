@@ -0,0 +1,133 @@
+// Block-compresses a texture for the editor: BC4 (RGTC1) for single-channel data such
+// as the high-frequency volume or the weather coverage, BC5 (RGTC2) for two-channel
+// data such as curl noise. Prints memory before/after and PSNR per channel.
+//
+//   bc_compress <input .vol|image> <output.vol> --format bc4|bc5 [--channel N] [--mips]
+
+#include "BlockCompression.hpp"
+#include "ThreadPool.hpp"
+#include "VolumeFile.hpp"
+#include "stb_image.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    double Psnr(double squaredError, size_t count) {
+        if (squaredError == 0.0 || count == 0) return INFINITY;
+        return 10.0 * std::log10(255.0 * 255.0 / (squaredError / (double)count));
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::fprintf(stderr, "usage: %s <input .vol|image> <output.vol> --format bc4|bc5 [--channel N] [--mips]\n", argv[0]);
+        return 1;
+    }
+
+    VolumeFormat format = VolumeFormat::BC4;
+    bool formatGiven = false;
+    uint32_t channel = 0;
+    bool mips = false;
+    for (int i = 3; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--format") && i + 1 < argc) {
+            const std::string f = argv[++i];
+            if (f == "bc4") format = VolumeFormat::BC4;
+            else if (f == "bc5") format = VolumeFormat::BC5;
+            else {
+                std::fprintf(stderr, "unknown format %s (expected bc4 or bc5)\n", f.c_str());
+                return 1;
+            }
+            formatGiven = true;
+        }
+        else if (!std::strcmp(argv[i], "--channel") && i + 1 < argc) channel = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--mips")) mips = true;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!formatGiven) {
+        std::fprintf(stderr, "--format is required\n");
+        return 1;
+    }
+
+    VolumeHeader header;
+    std::vector<unsigned char> source;
+    const std::filesystem::path input = argv[1];
+    try {
+        if (input.extension() == ".vol") {
+            MappedVolume volume(input);
+            header = volume.getHeader();
+            if (IsBlockCompressed(header.format)) throw std::runtime_error("input is already block compressed");
+            source.assign(volume.getLevel(0), volume.getLevel(0) + header.dataSize);
+        }
+        else {
+            int w = 0, h = 0, fileChannels = 0;
+            unsigned char* pixels = stbi_load(argv[1], &w, &h, &fileChannels, 4);
+            if (!pixels) throw std::runtime_error(stbi_failure_reason());
+            header.width = (uint32_t)w;
+            header.height = (uint32_t)h;
+            header.depth = 1;
+            header.format = (uint32_t)VolumeFormat::RGBA8;
+            header.channels = 4;
+            source.assign(pixels, pixels + (size_t)w * h * 4);
+            stbi_image_free(pixels);
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], e.what());
+        return 1;
+    }
+    if (mips && header.mipCount == 1) AppendVolumeMips(header, source);
+
+    // What the editor keeps in VRAM today: every texture is expanded to RGBA8.
+    VolumeHeader rgba = header;
+    rgba.format = (uint32_t)VolumeFormat::RGBA8;
+    rgba.channels = 4;
+    size_t before = 0;
+    for (uint32_t level = 0; level < header.mipCount; ++level) before += VolumeLevelSize(rgba, level);
+
+    ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    VolumeHeader compressed = header;
+    std::vector<unsigned char> blocks;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        blocks = CompressVolume(compressed, source.data(), format, channel, &pool);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // PSNR of level 0 per encoded channel against the source.
+    VolumeHeader decoded = compressed;
+    const std::vector<unsigned char> roundTrip = DecompressVolume(decoded, blocks.data());
+    const size_t texels = (size_t)header.width * header.height * header.depth;
+    for (uint32_t c = 0; c < compressed.channels; ++c) {
+        double error = 0.0;
+        for (size_t t = 0; t < texels; ++t) {
+            const double d = (double)source[t * header.channels + channel + c] - (double)roundTrip[t * compressed.channels + c];
+            error += d * d;
+        }
+        std::printf("channel %u: PSNR %.2f dB\n", channel + c, Psnr(error, texels));
+    }
+
+    if (!WriteVolumeFile(argv[2], compressed, blocks.data())) {
+        std::fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("%s -> %s: %ux%ux%u %s, %u mip(s), %.1f ms on %u threads\n", argv[1], argv[2], header.width, header.height,
+        header.depth, format == VolumeFormat::BC4 ? "BC4" : "BC5", compressed.mipCount, ms, pool.size());
+    std::printf("memory: %.1f KiB as RGBA8 -> %.1f KiB (%.1fx smaller)\n", before / 1024.0, blocks.size() / 1024.0,
+        (double)before / (double)blocks.size());
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Bakes a 3D noise strip (a width x width^2 image holding width slices stacked
+// vertically, e.g. textures/HighFrequency3DTexture.tga) into a .vol file that the
+// editor memory-maps at startup instead of decoding the image.
+//
+//   vol_convert <input image> <output.vol> [--mips] [--channels 1|2|4]
+//
+// --channels keeps the leading channels of the image (R, RG or RGBA).
+
+#include "VolumeFile.hpp"
+#include "stb_image.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <input image> <output.vol> [--mips] [--channels 1|2|4]\n", argv[0]);
+        return 1;
+    }
+
+    bool mips = false;
+    int channels = 4;
+    for (int i = 3; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--mips")) mips = true;
+        else if (!std::strcmp(argv[i], "--channels") && i + 1 < argc) channels = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (channels != 1 && channels != 2 && channels != 4) {
+        std::fprintf(stderr, "--channels must be 1, 2 or 4\n");
+        return 1;
+    }
+
+    int width = 0, height = 0, fileChannels = 0;
+    // Always expanded to RGBA: asked for fewer channels, stbi would fold RGB into
+    // luminance instead of keeping the leading ones (see Texture::Decode).
+    unsigned char* pixels = stbi_load(argv[1], &width, &height, &fileChannels, 4);
+    if (!pixels) {
+        std::fprintf(stderr, "%s: %s\n", argv[1], stbi_failure_reason());
+        return 1;
+    }
+    if (height != width * width) {
+        std::fprintf(stderr, "%s: %dx%d is not a width x width^2 strip\n", argv[1], width, height);
+        stbi_image_free(pixels);
+        return 1;
+    }
+
+    VolumeHeader header;
+    header.width = header.height = header.depth = (uint32_t)width;
+    header.channels = (uint32_t)channels;
+    header.format = (uint32_t)channels; // VolumeFormat values equal the channel count
+
+    // The strip stores slice z as rows [z*width, (z+1)*width), which is already x/y/z order.
+    const size_t texels = (size_t)width * height;
+    std::vector<unsigned char> data(texels * channels);
+    for (size_t i = 0; i < texels; ++i) {
+        std::memcpy(&data[i * channels], &pixels[i * 4], (size_t)channels);
+    }
+    stbi_image_free(pixels);
+
+    if (mips) AppendVolumeMips(header, data);
+
+    if (!WriteVolumeFile(argv[2], header, data.data())) {
+        std::fprintf(stderr, "cannot write %s\n", argv[2]);
+        return 1;
+    }
+    std::printf("%s -> %s: %ux%ux%u, %u channel(s), %u mip(s), %zu bytes\n",
+        argv[1], argv[2], header.width, header.height, header.depth, header.channels, header.mipCount, data.size());
+    return 0;
+}